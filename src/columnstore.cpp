@@ -0,0 +1,170 @@
+#include "columnstore.h"
+
+#include "stringpool.h"
+#include "timeutils.h"
+
+#include <cmath>
+
+namespace
+{
+    // Field of the event shown in each string column, or -1
+    int StringColumnIndex(int column)
+    {
+        switch (column)
+        {
+            case COL::File: return LogEvent::File;
+            case COL::TID: return LogEvent::Thread;
+            case COL::Severity: return LogEvent::Severity;
+            case COL::Request: return LogEvent::Request;
+            case COL::Session: return LogEvent::Session;
+            case COL::Site: return LogEvent::Site;
+            case COL::User: return LogEvent::User;
+            case COL::Key: return LogEvent::Key;
+        }
+        return -1;
+    }
+}
+
+bool ColumnStore::IsStringColumn(int column)
+{
+    return StringColumnIndex(column) >= 0;
+}
+
+LogEvent::Field ColumnStore::FieldOfColumn(int column)
+{
+    return static_cast<LogEvent::Field>(StringColumnIndex(column));
+}
+
+int ColumnStore::Size() const
+{
+    return m_ids.size();
+}
+
+void ColumnStore::Reserve(int size)
+{
+    m_ids.reserve(size);
+    m_pids.reserve(size);
+    m_times.reserve(size);
+    m_elapsed.reserve(size);
+    m_flags.reserve(size);
+    for (auto& codes : m_strings)
+    {
+        codes.reserve(size);
+    }
+    m_values.reserve(size);
+}
+
+void ColumnStore::Insert(int row, const LogEvent& event, qint64 time)
+{
+    m_ids.insert(row, event.Index());
+    m_pids.insert(row, event.Pid());
+    m_times.insert(row, time);
+    m_elapsed.insert(row, std::nan(""));
+    quint8 flags = 0;
+    if (event.contains("a"))
+        flags |= HasArtFlag;
+    if (event.contains("e"))
+        flags |= HasErrorCodeFlag;
+    m_flags.insert(row, flags);
+    for (int field = 0; field < LogEvent::FieldCount; field++)
+    {
+        m_strings[field].insert(row, event.FieldCode(static_cast<LogEvent::Field>(field)));
+    }
+    m_values.insert(row, QString());
+}
+
+void ColumnStore::Remove(int row, int count)
+{
+    m_ids.remove(row, count);
+    m_pids.remove(row, count);
+    m_times.remove(row, count);
+    m_elapsed.remove(row, count);
+    m_flags.remove(row, count);
+    for (auto& codes : m_strings)
+    {
+        codes.remove(row, count);
+    }
+    m_values.remove(row, count);
+}
+
+void ColumnStore::Clear()
+{
+    *this = ColumnStore();
+}
+
+QVariant ColumnStore::Data(int row, int column) const
+{
+    if (row < 0 || row >= Size())
+        return QVariant();
+
+    switch (column)
+    {
+        case COL::ID:
+            return m_ids[row];
+        case COL::PID:
+            return m_pids[row];
+        case COL::Time:
+            return TimeUtils::ToDateTime(m_times[row]);
+        case COL::Elapsed:
+            return std::isnan(m_elapsed[row]) ? QVariant() : QVariant(m_elapsed[row]);
+        case COL::Value:
+            return m_values[row].isNull() ? QVariant() : QVariant(m_values[row]);
+    }
+
+    int field = StringColumnIndex(column);
+    if (field >= 0)
+        return StringPool::Get(m_strings[field][row]);
+    return QVariant();
+}
+
+quint32 ColumnStore::Code(int row, int column) const
+{
+    return m_strings[StringColumnIndex(column)][row];
+}
+
+qint64 ColumnStore::Time(int row) const
+{
+    return m_times[row];
+}
+
+double ColumnStore::Elapsed(int row) const
+{
+    return m_elapsed[row];
+}
+
+void ColumnStore::SetElapsed(int row, double elapsed)
+{
+    m_elapsed[row] = elapsed;
+}
+
+bool ColumnStore::HasArt(int row) const
+{
+    return m_flags[row] & HasArtFlag;
+}
+
+bool ColumnStore::HasErrorCode(int row) const
+{
+    return m_flags[row] & HasErrorCodeFlag;
+}
+
+void ColumnStore::Touch(int row)
+{
+    m_flags[row] |= TouchedFlag;
+}
+
+bool ColumnStore::TakeTouched(int row)
+{
+    const bool touched = m_flags[row] & TouchedFlag;
+    m_flags[row] &= ~TouchedFlag;
+    return touched;
+}
+
+const QString& ColumnStore::ValueString(int row) const
+{
+    return m_values[row];
+}
+
+void ColumnStore::SetValueString(int row, const QString& str)
+{
+    m_values[row] = str;
+}
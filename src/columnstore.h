@@ -0,0 +1,67 @@
+#ifndef COLUMNSTORE_H
+#define COLUMNSTORE_H
+
+#include "column.h"
+#include "logevent.h"
+
+#include <QList>
+#include <QString>
+#include <QVariant>
+
+// Column-oriented storage for the fixed columns of the top-level rows of a TreeModel.
+// Each column is one contiguous array: times (see TimeUtils), ids and pids are integers, Elapsed is a double,
+// and the string columns hold the StringPool codes of the events. Scanning a column over
+// millions of rows reads one array instead of a QVariant per cell.
+// A string that isn't interned has the code StringPool::Uninterned and is read from the event,
+// see LogEvent::FieldString().
+// ART and Error Code only record whether the event has them, their text comes from the event.
+class ColumnStore
+{
+public:
+    int Size() const;
+    void Reserve(int size);
+    // time is in microseconds, or TimeUtils::InvalidTime
+    void Insert(int row, const LogEvent& event, qint64 time);
+    void Remove(int row, int count);
+    void Clear();
+
+    // Returns the content of a cell the way a TreeItem used to hold it. ART and Error Code
+    // are not stored and return an invalid QVariant, see HasArt() and HasErrorCode().
+    QVariant Data(int row, int column) const;
+
+    static bool IsStringColumn(int column);
+    // The LogEvent::Field shown in a string column
+    static LogEvent::Field FieldOfColumn(int column);
+    // StringPool code of a string column
+    quint32 Code(int row, int column) const;
+    qint64 Time(int row) const;
+    double Elapsed(int row) const;
+    void SetElapsed(int row, double elapsed);
+    bool HasArt(int row) const;
+    bool HasErrorCode(int row) const;
+    // Marks a row as used. TakeTouched() tells whether it was used since the last call.
+    void Touch(int row);
+    bool TakeTouched(int row);
+
+    // Display string of the Value column. Null until it is set.
+    const QString& ValueString(int row) const;
+    void SetValueString(int row, const QString& str);
+
+private:
+    enum Flag : quint8
+    {
+        HasArtFlag = 0x1,
+        HasErrorCodeFlag = 0x2,
+        TouchedFlag = 0x4
+    };
+
+    QList<qint32> m_ids;
+    QList<qint32> m_pids;
+    QList<qint64> m_times;
+    QList<double> m_elapsed;
+    QList<quint8> m_flags;
+    QList<quint32> m_strings[LogEvent::FieldCount];
+    QList<QString> m_values;
+};
+
+#endif // COLUMNSTORE_H
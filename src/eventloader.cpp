@@ -0,0 +1,320 @@
+#include "eventloader.h"
+
+#include "eventparser.h"
+#include "logsource.h"
+#include "processevent.h"
+#include "timeutils.h"
+
+#include <functional>
+#include <queue>
+#include <QList>
+#include <QThread>
+#include <QtConcurrent>
+
+namespace
+{
+    // Buffers smaller than this are not worth the overhead of splitting across threads.
+    const qsizetype MinParallelSize = 4 * 1024 * 1024;
+    // Lower bound for a chunk, to keep the per-task overhead small.
+    const qsizetype MinChunkSize = 1024 * 1024;
+    // Create a few chunks per thread so a chunk full of long events doesn't hold everyone up.
+    const int ChunksPerThread = 4;
+
+    struct Chunk
+    {
+        QByteArrayView data;
+        QString fileName;
+        int firstIndex = 0;
+        int lineCount = 0;
+    };
+
+    struct ChunkResult
+    {
+        EventList events;
+        int skippedCount = 0;
+        bool failed = false;
+    };
+
+    struct MemberResult
+    {
+        EventListPtr events;
+        int skippedCount = 0;
+    };
+
+    int ParseSerial(QByteArrayView data, const QString& fileName, const ParseSettings& settings, const LogSourcePtr& source, int firstIndex, EventList& events, int& skippedCount)
+    {
+        int index = firstIndex;
+        LogSource::ForEachLine(data, [&](QByteArrayView line) {
+            LogEvent ev = ProcessEvent::ProcessLogEventMessage(index++, line, fileName, settings, source);
+            if (!ev.isEmpty())
+            {
+                events.append(ev);
+            }
+            else
+            {
+                skippedCount++;
+            }
+        });
+        return index - firstIndex;
+    }
+
+
+    // The time of a line, read without parsing it. InvalidTime if the line has none.
+    qint64 LineTime(QByteArrayView line)
+    {
+        line = line.trimmed();
+        QByteArrayView ts;
+        if (!line.startsWith('{') || !EventParser::FindTimestamp(line, ts) || ts.size() > 32)
+            return TimeUtils::InvalidTime;
+        return TimeUtils::ParseTimestamp(QString::fromLatin1(ts));
+    }
+
+    // Returns the start of the first line that starts at or after pos
+    qsizetype NextLineStart(QByteArrayView data, qsizetype pos)
+    {
+        if (pos == 0)
+            return 0;
+        qsizetype eol = data.indexOf('\n', pos - 1);
+        return (eol < 0) ? data.size() : eol + 1;
+    }
+
+    // Returns the time of the first line with a time that starts at or after pos
+    qint64 NextTime(QByteArrayView data, qsizetype pos)
+    {
+        qsizetype start = NextLineStart(data, pos);
+        while (start < data.size())
+        {
+            qsizetype eol = data.indexOf('\n', start);
+            qsizetype end = (eol < 0) ? data.size() : eol;
+            qint64 time = LineTime(data.sliced(start, end - start));
+            if (time != TimeUtils::InvalidTime)
+                return time;
+            start = end + 1;
+        }
+        return TimeUtils::InvalidTime;
+    }
+
+    // Returns the start of the first line from which on the times are at or after time, or only
+    // after time if afterTime is set
+    qsizetype FindTimeOffset(QByteArrayView data, qint64 time, bool afterTime)
+    {
+        qsizetype low = 0;
+        qsizetype high = data.size();
+        while (low < high)
+        {
+            const qsizetype mid = low + (high - low) / 2;
+            const qint64 next = NextTime(data, mid);
+            const bool before = next != TimeUtils::InvalidTime && (afterTime ? next <= time : next < time);
+            if (before)
+                low = mid + 1;
+            else
+                high = mid;
+        }
+        return NextLineStart(data, low);
+    }
+
+    QList<Chunk> SplitIntoChunks(QByteArrayView data, const QString& fileName)
+    {
+        const int chunkCount = QThread::idealThreadCount() * ChunksPerThread;
+        const qsizetype chunkSize = qMax(MinChunkSize, data.size() / chunkCount);
+
+        QList<Chunk> chunks;
+        qsizetype start = 0;
+        while (start < data.size())
+        {
+            qsizetype end = start + chunkSize;
+            if (end >= data.size())
+            {
+                end = data.size();
+            }
+            else
+            {
+                // Move the boundary past the end of the line it falls into
+                qsizetype eol = data.indexOf('\n', end);
+                end = (eol < 0) ? data.size() : eol + 1;
+            }
+
+            Chunk chunk;
+            chunk.data = data.sliced(start, end - start);
+            chunk.fileName = fileName;
+            chunks.append(chunk);
+            start = end;
+        }
+        return chunks;
+    }
+}
+
+namespace EventLoader
+{
+    int ParseEvents(QByteArrayView data, const QString& fileName, int firstIndex, EventList& events, int& skippedCount, const ParseSettings& settings, const LogSourcePtr& source)
+    {
+        if (data.size() < MinParallelSize || QThread::idealThreadCount() < 2)
+        {
+            return ParseSerial(data, fileName, settings, source, firstIndex, events, skippedCount);
+        }
+
+        QList<Chunk> chunks = SplitIntoChunks(data, fileName);
+
+        // Event indices are assigned per line, so count the lines of every chunk first
+        // to know where each chunk starts numbering.
+        QtConcurrent::blockingMap(chunks, [](Chunk& chunk) {
+            chunk.lineCount = CountLines(chunk.data);
+        });
+        int index = firstIndex;
+        for (Chunk& chunk : chunks)
+        {
+            chunk.firstIndex = index;
+            index += chunk.lineCount;
+        }
+
+        QList<ChunkResult> results = QtConcurrent::blockingMapped<QList<ChunkResult>>(chunks, [&settings, &source](const Chunk& chunk) {
+            ChunkResult result;
+            ParseSerial(chunk.data, chunk.fileName, settings, source, chunk.firstIndex, result.events, result.skippedCount);
+            return result;
+        });
+
+        qsizetype totalEvents = 0;
+        for (const ChunkResult& result : results)
+        {
+            totalEvents += result.events.size();
+        }
+        events.reserve(events.size() + totalEvents);
+        for (ChunkResult& result : results)
+        {
+            events.append(std::move(result.events));
+            skippedCount += result.skippedCount;
+        }
+        return index - firstIndex;
+    }
+
+    QList<EventListPtr> ParseZipMembers(const ZipArchive& archive, const QStringList& memberNames, const ParseSettings& settings, int& skippedCount, QStringList& failedMembers)
+    {
+        QList<MemberResult> results = QtConcurrent::blockingMapped<QList<MemberResult>>(memberNames, [&archive, &settings](const QString& memberName) {
+            MemberResult result;
+            result.events = std::make_shared<EventList>();
+            const ZipArchive::Entry* entry = archive.FindEntry(memberName);
+            QByteArray data;
+            if (entry && archive.Extract(*entry, data))
+            {
+                // Big members are split across threads again, small ones are parsed in place
+                ParseEvents(data, memberName, 1, *result.events, result.skippedCount, settings);
+            }
+            else
+            {
+                result.failed = true;
+            }
+            return result;
+        });
+
+        QList<EventListPtr> memberEvents;
+        for (int i = 0; i < results.size(); i++)
+        {
+            memberEvents.append(results[i].events);
+            skippedCount += results[i].skippedCount;
+            if (results[i].failed)
+            {
+                failedMembers.append(memberNames[i]);
+            }
+        }
+        return memberEvents;
+    }
+
+    int CountLines(QByteArrayView data)
+    {
+        int count = 0;
+        LogSource::ForEachLine(data, [&count](QByteArrayView) { count++; });
+        return count;
+    }
+
+    qsizetype FindLinesEnd(QByteArrayView data, int lineCount)
+    {
+        const char* begin = data.data();
+        const char* pos = begin;
+        const char* const end = begin + data.size();
+        for (int i = 0; i < lineCount && pos < end; i++)
+        {
+            const char* eol = static_cast<const char*>(std::memchr(pos, '\n', end - pos));
+            pos = eol ? eol + 1 : end;
+        }
+        return pos - begin;
+    }
+
+    bool FindTimeBounds(QByteArrayView data, qint64& first, qint64& last)
+    {
+        first = NextTime(data, 0);
+        if (first == TimeUtils::InvalidTime)
+            return false;
+
+        // Walk back from the end to the last line with a time
+        qsizetype end = data.size();
+        while (end > 0)
+        {
+            const qsizetype start = data.lastIndexOf('\n', end - 1) + 1;
+            last = LineTime(data.sliced(start, end - start));
+            if (last != TimeUtils::InvalidTime)
+                return true;
+            end = start - 1;
+        }
+        last = first;
+        return true;
+    }
+
+    QByteArrayView FindTimeRange(QByteArrayView data, qint64 startTime, qint64 endTime)
+    {
+        const qsizetype begin = FindTimeOffset(data, startTime, false);
+        const qsizetype end = qMax(begin, FindTimeOffset(data, endTime, true));
+        return data.sliced(begin, end - begin);
+    }
+
+    EventList MergeSorted(const QList<const EventList*>& lists)
+    {
+        // Heads are ordered by time, then by list so ties keep the order of the lists
+        typedef std::pair<qint64, int> Head;
+        std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+        QList<qsizetype> positions(lists.size(), 0);
+        QList<const EventList*> unsorted;
+        qsizetype total = 0;
+        for (int i = 0; i < lists.size(); i++)
+        {
+            const EventList& list = *lists[i];
+            if (list.isEmpty())
+                continue;
+            if (list.first().Timestamp().isEmpty())
+            {
+                unsorted.append(&list);
+                continue;
+            }
+            total += list.size();
+            heads.push({TimeUtils::ParseTimestamp(list.first().Timestamp()), i});
+        }
+
+        EventList merged;
+        merged.reserve(total);
+        while (!heads.empty())
+        {
+            const int i = heads.top().second;
+            heads.pop();
+            const EventList& list = *lists[i];
+            qsizetype& pos = positions[i];
+            merged.append(list[pos++]);
+
+            // Stay on this list while it remains first, without going through the heap
+            while (pos < list.size())
+            {
+                const Head next {TimeUtils::ParseTimestamp(list[pos].Timestamp()), i};
+                if (!heads.empty() && heads.top() < next)
+                {
+                    heads.push(next);
+                    break;
+                }
+                merged.append(list[pos++]);
+            }
+        }
+
+        for (const EventList* list : unsorted)
+        {
+            merged.append(*list);
+        }
+        return merged;
+    }
+}
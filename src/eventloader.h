@@ -0,0 +1,51 @@
+#ifndef EVENTLOADER_H
+#define EVENTLOADER_H
+
+#include "options.h"
+#include "treemodel.h"
+#include "ziparchive.h"
+
+#include <QByteArrayView>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+namespace EventLoader
+{
+    // Parses every non-empty line of data into events and appends them to events.
+    // Event indices start at firstIndex and are assigned per line, including skipped lines.
+    // Large buffers are split into newline-aligned chunks that are parsed concurrently and
+    // stitched back together in order.
+    // Returns the number of lines consumed, so callers can continue numbering after it.
+    // If data is a part of the data of source, the events read their values back from source.
+    int ParseEvents(QByteArrayView data, const QString& fileName, int firstIndex, EventList& events, int& skippedCount, const ParseSettings& settings, const LogSourcePtr& source = nullptr);
+
+    // Decompresses and parses the given members of an archive concurrently, one task per member.
+    // Returns the events of every member, in the order of memberNames. The file name of the
+    // events is the member name. Members that can't be extracted have no events and are added
+    // to failedMembers.
+    QList<EventListPtr> ParseZipMembers(const ZipArchive& archive, const QStringList& memberNames, const ParseSettings& settings, int& skippedCount, QStringList& failedMembers);
+
+    // Returns the number of lines of data that get an event index, which are the non-empty ones
+    int CountLines(QByteArrayView data);
+
+    // Returns the offset right after the first lineCount lines of data, or data.size() if
+    // there are fewer lines than that.
+    qsizetype FindLinesEnd(QByteArrayView data, int lineCount);
+
+    // Sets first and last to the times of the first and last lines of data that have one.
+    // Returns false if no line has a time.
+    bool FindTimeBounds(QByteArrayView data, qint64& first, qint64& last);
+
+    // Returns the lines of data, which is sorted by time, that cover the times from startTime to
+    // endTime. The bounds are found by a binary search over byte offsets that reads the time of the
+    // line following each probe, so only a few pages of a huge file are touched.
+    QByteArrayView FindTimeRange(QByteArrayView data, qint64 startTime, qint64 endTime);
+
+    // Merges event lists that are each sorted by time into one sorted list, in a single pass over
+    // a heap of the heads of the lists. Events with the same time keep the order of the lists.
+    // Lists that don't start with a timestamp can't be merged and are appended at the end.
+    EventList MergeSorted(const QList<const EventList*>& lists);
+}
+
+#endif // EVENTLOADER_H
@@ -0,0 +1,604 @@
+#include "eventparser.h"
+
+#include <QByteArray>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonValue>
+#include <QString>
+#include <QtAlgorithms>
+
+#include <charconv>
+#include <cstring>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define EVENTPARSER_USE_SSE2
+#endif
+
+namespace
+{
+    const int BlockSize = 64;
+
+    struct BlockMasks
+    {
+        uint64_t quote;
+        uint64_t backslash;
+        uint64_t structural;
+    };
+
+    // Builds bit masks of the interesting characters in a 64 byte block. Bit i is set when
+    // byte i of the block matches.
+    inline BlockMasks ScanBlock(const char* block)
+    {
+        BlockMasks masks { 0, 0, 0 };
+#ifdef EVENTPARSER_USE_SSE2
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        const __m128i caseBit = _mm_set1_epi8(0x20);
+        // '[' and ']' only differ from '{' and '}' by the 0x20 bit
+        const __m128i openBrace = _mm_set1_epi8('{');
+        const __m128i closeBrace = _mm_set1_epi8('}');
+        const __m128i colon = _mm_set1_epi8(':');
+        const __m128i comma = _mm_set1_epi8(',');
+        for (int i = 0; i < BlockSize / 16; i++)
+        {
+            __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i * 16));
+            __m128i folded = _mm_or_si128(chars, caseBit);
+            __m128i structural = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(folded, openBrace), _mm_cmpeq_epi8(folded, closeBrace)),
+                _mm_or_si128(_mm_cmpeq_epi8(chars, colon), _mm_cmpeq_epi8(chars, comma)));
+
+            const int shift = i * 16;
+            masks.quote |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chars, quote)))) << shift;
+            masks.backslash |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chars, backslash)))) << shift;
+            masks.structural |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(structural))) << shift;
+        }
+#else
+        for (int i = 0; i < BlockSize; i++)
+        {
+            const uint64_t bit = uint64_t(1) << i;
+            switch (block[i])
+            {
+            case '"': masks.quote |= bit; break;
+            case '\\': masks.backslash |= bit; break;
+            case '{': case '}': case '[': case ']': case ':': case ',': masks.structural |= bit; break;
+            default: break;
+            }
+        }
+#endif
+        return masks;
+    }
+
+    // Bit i of the result is the XOR of bits 0..i of the input.
+    // Applied to the quote mask, it yields the bytes that are inside of strings.
+    inline uint64_t PrefixXor(uint64_t bits)
+    {
+        bits ^= bits << 1;
+        bits ^= bits << 2;
+        bits ^= bits << 4;
+        bits ^= bits << 8;
+        bits ^= bits << 16;
+        bits ^= bits << 32;
+        return bits;
+    }
+
+    inline bool IsSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    inline bool IsBlank(const char* begin, const char* end)
+    {
+        for (; begin < end; begin++)
+        {
+            if (!IsSpace(*begin))
+                return false;
+        }
+        return true;
+    }
+
+    void AppendUtf8(QByteArray& out, uint32_t codePoint)
+    {
+        if (codePoint < 0x80)
+        {
+            out.append(static_cast<char>(codePoint));
+        }
+        else if (codePoint < 0x800)
+        {
+            out.append(static_cast<char>(0xC0 | (codePoint >> 6)));
+            out.append(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+        else if (codePoint < 0x10000)
+        {
+            out.append(static_cast<char>(0xE0 | (codePoint >> 12)));
+            out.append(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            out.append(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+        else
+        {
+            out.append(static_cast<char>(0xF0 | (codePoint >> 18)));
+            out.append(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+            out.append(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            out.append(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+    }
+
+    bool ParseHex4(const char* pos, const char* end, uint32_t& value)
+    {
+        if (end - pos < 4)
+            return false;
+        auto result = std::from_chars(pos, pos + 4, value, 16);
+        return result.ec == std::errc() && result.ptr == pos + 4;
+    }
+
+    // Decodes the content of a JSON string (without the quotes)
+    bool DecodeString(const char* begin, const char* end, QString& out)
+    {
+        const char* escape = static_cast<const char*>(std::memchr(begin, '\\', end - begin));
+        if (!escape)
+        {
+            out = QString::fromUtf8(begin, end - begin);
+            return true;
+        }
+
+        QByteArray buffer;
+        buffer.reserve(end - begin);
+        const char* pos = begin;
+        while (pos < end)
+        {
+            if (*pos != '\\')
+            {
+                const char* next = static_cast<const char*>(std::memchr(pos, '\\', end - pos));
+                if (!next)
+                    next = end;
+                buffer.append(pos, next - pos);
+                pos = next;
+                continue;
+            }
+
+            if (++pos >= end)
+                return false;
+            switch (*pos++)
+            {
+            case '"': buffer.append('"'); break;
+            case '\\': buffer.append('\\'); break;
+            case '/': buffer.append('/'); break;
+            case 'b': buffer.append('\b'); break;
+            case 'f': buffer.append('\f'); break;
+            case 'n': buffer.append('\n'); break;
+            case 'r': buffer.append('\r'); break;
+            case 't': buffer.append('\t'); break;
+            case 'u':
+            {
+                uint32_t codePoint;
+                if (!ParseHex4(pos, end, codePoint))
+                    return false;
+                pos += 4;
+                if (codePoint >= 0xD800 && codePoint <= 0xDBFF)
+                {
+                    // High surrogate, combine it with the low surrogate that should follow
+                    uint32_t low;
+                    if (end - pos >= 6 && pos[0] == '\\' && pos[1] == 'u' &&
+                        ParseHex4(pos + 2, end, low) && low >= 0xDC00 && low <= 0xDFFF)
+                    {
+                        codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                        pos += 6;
+                    }
+                    else
+                    {
+                        codePoint = 0xFFFD;
+                    }
+                }
+                else if (codePoint >= 0xDC00 && codePoint <= 0xDFFF)
+                {
+                    codePoint = 0xFFFD;
+                }
+                AppendUtf8(buffer, codePoint);
+                break;
+            }
+            default:
+                return false;
+            }
+        }
+        out = QString::fromUtf8(buffer);
+        return true;
+    }
+
+    // Decodes a number, true, false or null
+    bool DecodeLiteral(const char* begin, const char* end, QJsonValue& value)
+    {
+        while (begin < end && IsSpace(*begin))
+            begin++;
+        while (end > begin && IsSpace(*(end - 1)))
+            end--;
+
+        const qsizetype size = end - begin;
+        if (size == 0)
+            return false;
+
+        if (*begin == '-' || (*begin >= '0' && *begin <= '9'))
+        {
+            // Keep integers as integers, like the Qt parser does
+            qint64 integer;
+            auto result = std::from_chars(begin, end, integer);
+            if (result.ec == std::errc() && result.ptr == end)
+            {
+                value = QJsonValue(integer);
+                return true;
+            }
+
+            bool ok = false;
+            double number = QByteArray::fromRawData(begin, size).toDouble(&ok);
+            if (!ok)
+                return false;
+            value = QJsonValue(number);
+            return true;
+        }
+        if (size == 4 && std::memcmp(begin, "true", 4) == 0)
+        {
+            value = QJsonValue(true);
+            return true;
+        }
+        if (size == 5 && std::memcmp(begin, "false", 5) == 0)
+        {
+            value = QJsonValue(false);
+            return true;
+        }
+        if (size == 4 && std::memcmp(begin, "null", 4) == 0)
+        {
+            value = QJsonValue(QJsonValue::Null);
+            return true;
+        }
+        return false;
+    }
+
+    // Keys of the Tableau log schema. Matching them avoids allocating a new key string for
+    // every event.
+    const QString& KeyString(const char* begin, const char* end, QString& buffer, bool& ok)
+    {
+        static const QString KnownKeys[] = {
+            QStringLiteral("ts"), QStringLiteral("pid"), QStringLiteral("tid"), QStringLiteral("sev"),
+            QStringLiteral("req"), QStringLiteral("sess"), QStringLiteral("site"), QStringLiteral("user"),
+            QStringLiteral("k"), QStringLiteral("a"), QStringLiteral("e"), QStringLiteral("v")
+        };
+        static const char* const KnownKeyNames[] = {
+            "ts", "pid", "tid", "sev", "req", "sess", "site", "user", "k", "a", "e", "v"
+        };
+
+        const size_t size = end - begin;
+        if (size <= 4)
+        {
+            for (size_t i = 0; i < sizeof(KnownKeyNames) / sizeof(KnownKeyNames[0]); i++)
+            {
+                if (std::strlen(KnownKeyNames[i]) == size && std::memcmp(KnownKeyNames[i], begin, size) == 0)
+                {
+                    ok = true;
+                    return KnownKeys[i];
+                }
+            }
+        }
+        ok = DecodeString(begin, end, buffer);
+        return buffer;
+    }
+
+    // Finds the string value of a top-level key that Tableau logs write among the flat header
+    // fields at the start of the line. quotedName is the key with its quotes.
+    bool FindHeaderString(QByteArrayView line, QByteArrayView quotedName, QByteArrayView& value)
+    {
+        const qsizetype keyPos = line.indexOf(quotedName);
+        if (keyPos < 0)
+            return false;
+
+        // As long as nothing before the match can hide a quote or open a nested value, the match
+        // is the top-level key.
+        int quotes = 0;
+        for (qsizetype i = 1; i < keyPos; i++)
+        {
+            const char c = line[i];
+            if (c == '\\' || c == '{' || c == '[')
+                return false;
+            if (c == '"')
+                quotes++;
+        }
+        if (quotes % 2 != 0)
+            return false;
+
+        const char* pos = line.data() + keyPos + quotedName.size();
+        const char* const end = line.data() + line.size();
+        while (pos < end && IsSpace(*pos))
+            pos++;
+        if (pos >= end || *pos++ != ':')
+            return false;
+        while (pos < end && IsSpace(*pos))
+            pos++;
+        if (pos >= end || *pos++ != '"')
+            return false;
+
+        const char* close = static_cast<const char*>(std::memchr(pos, '"', end - pos));
+        if (!close || std::memchr(pos, '\\', close - pos))
+            return false;
+        value = QByteArrayView(pos, close - pos);
+        return true;
+    }
+}
+
+namespace EventParser
+{
+    bool FindStructurals(QByteArrayView data, std::vector<uint32_t>& positions)
+    {
+        positions.clear();
+
+        const char* const input = data.data();
+        const qsizetype size = data.size();
+        // Bit 0 is set when the first byte of the next block is escaped by a trailing backslash
+        uint64_t carriedEscape = 0;
+        // All ones when the previous block ended inside of a string
+        uint64_t carriedInString = 0;
+
+        for (qsizetype blockStart = 0; blockStart < size; blockStart += BlockSize)
+        {
+            const char* block = input + blockStart;
+            char padded[BlockSize];
+            if (size - blockStart < BlockSize)
+            {
+                // Pad the last block with whitespace, which is never structural
+                std::memset(padded, ' ', BlockSize);
+                std::memcpy(padded, block, size - blockStart);
+                block = padded;
+            }
+
+            const BlockMasks masks = ScanBlock(block);
+
+            // Find the characters escaped by a backslash. Backslashes are rare outside of query
+            // text, so walking them one by one is cheaper than the branchless bit tricks.
+            uint64_t escaped = carriedEscape;
+            carriedEscape = 0;
+            for (uint64_t backslashes = masks.backslash; backslashes; backslashes &= backslashes - 1)
+            {
+                const int bit = qCountTrailingZeroBits(backslashes);
+                if (escaped & (uint64_t(1) << bit))
+                    continue;
+                if (bit == BlockSize - 1)
+                    carriedEscape = 1;
+                else
+                    escaped |= uint64_t(1) << (bit + 1);
+            }
+
+            const uint64_t quotes = masks.quote & ~escaped;
+            const uint64_t inString = PrefixXor(quotes) ^ carriedInString;
+            carriedInString = static_cast<uint64_t>(static_cast<int64_t>(inString) >> 63);
+
+            for (uint64_t structural = (masks.structural & ~inString) | quotes; structural; structural &= structural - 1)
+            {
+                positions.push_back(static_cast<uint32_t>(blockStart + qCountTrailingZeroBits(structural)));
+            }
+        }
+        return carriedInString == 0;
+    }
+
+    bool ParseObject(QByteArrayView line, QJsonObject& obj, QByteArrayView* rawValue)
+    {
+        // Positions are 32-bit, leave anything bigger to the Qt parser
+        if (line.size() >= std::numeric_limits<uint32_t>::max())
+            return false;
+
+        thread_local std::vector<uint32_t> positions;
+        if (!FindStructurals(line, positions))
+            return false;
+
+        const char* const data = line.data();
+        const char* const end = data + line.size();
+        const size_t count = positions.size();
+        auto charAt = [&](size_t i) { return data[positions[i]]; };
+
+        if (count < 2 || charAt(0) != '{' || !IsBlank(data, data + positions[0]))
+            return false;
+
+        QString keyBuffer;
+        QString stringValue;
+        size_t i = 1;
+        if (charAt(i) != '}')
+        {
+            while (true)
+            {
+                // Key
+                if (i + 2 >= count || charAt(i) != '"' || charAt(i + 1) != '"' || charAt(i + 2) != ':')
+                    return false;
+                if (!IsBlank(data + positions[i - 1] + 1, data + positions[i]) ||
+                    !IsBlank(data + positions[i + 1] + 1, data + positions[i + 2]))
+                    return false;
+                bool keyOk = false;
+                const QString& key = KeyString(data + positions[i] + 1, data + positions[i + 1], keyBuffer, keyOk);
+                if (!keyOk)
+                    return false;
+                const uint32_t colon = positions[i + 2];
+                i += 3;
+                if (i >= count)
+                    return false;
+
+                // Value
+                const char c = charAt(i);
+                if (c == '"')
+                {
+                    if (i + 1 >= count || charAt(i + 1) != '"' || !IsBlank(data + colon + 1, data + positions[i]))
+                        return false;
+                    if (!DecodeString(data + positions[i] + 1, data + positions[i + 1], stringValue))
+                        return false;
+                    obj.insert(key, stringValue);
+                    i += 2;
+                    if (i >= count || !IsBlank(data + positions[i - 1] + 1, data + positions[i]))
+                        return false;
+                }
+                else if (c == '{' || c == '[')
+                {
+                    if (!IsBlank(data + colon + 1, data + positions[i]))
+                        return false;
+                    // Find the matching bracket. Quotes don't affect the depth.
+                    int depth = 0;
+                    size_t close = i;
+                    for (; close < count; close++)
+                    {
+                        const char s = charAt(close);
+                        if (s == '{' || s == '[')
+                            depth++;
+                        else if (s == '}' || s == ']')
+                        {
+                            if (--depth == 0)
+                                break;
+                        }
+                    }
+                    if (close >= count)
+                        return false;
+
+                    const uint32_t begin = positions[i];
+                    const uint32_t length = positions[close] + 1 - begin;
+                    if (rawValue && key == QLatin1String("v"))
+                    {
+                        *rawValue = QByteArrayView(data + begin, length);
+                    }
+                    else
+                    {
+                        QJsonParseError error;
+                        QJsonDocument doc = QJsonDocument::fromJson(QByteArray::fromRawData(data + begin, length), &error);
+                        if (error.error != QJsonParseError::NoError)
+                            return false;
+                        if (doc.isObject())
+                            obj.insert(key, doc.object());
+                        else
+                            obj.insert(key, doc.array());
+                    }
+                    i = close + 1;
+                    if (i >= count || !IsBlank(data + positions[close] + 1, data + positions[i]))
+                        return false;
+                }
+                else
+                {
+                    // Number or literal, it spans up to the next structural character
+                    QJsonValue value;
+                    if (!DecodeLiteral(data + colon + 1, data + positions[i], value))
+                        return false;
+                    obj.insert(key, value);
+                }
+
+                if (charAt(i) == ',')
+                {
+                    i++;
+                    continue;
+                }
+                if (charAt(i) == '}')
+                    break;
+                return false;
+            }
+        }
+        else if (!IsBlank(data + positions[0] + 1, data + positions[1]))
+        {
+            return false;
+        }
+
+        // The closing brace must be the last thing on the line
+        return i == count - 1 && IsBlank(data + positions[i] + 1, end);
+    }
+
+    int FindMembers(QByteArrayView data, const QList<QByteArrayView>& keys, QList<QByteArrayView>& values)
+    {
+        values.fill(QByteArrayView(), keys.size());
+        if (data.size() >= std::numeric_limits<uint32_t>::max())
+            return 0;
+
+        thread_local std::vector<uint32_t> positions;
+        if (!FindStructurals(data, positions))
+            return 0;
+
+        const char* const chars = data.data();
+        const size_t count = positions.size();
+        int found = 0;
+        int depth = 0;
+        for (size_t i = 0; i < count && found < keys.size(); i++)
+        {
+            const char c = chars[positions[i]];
+            if (c == '{' || c == '[')
+            {
+                depth++;
+                continue;
+            }
+            if (c == '}' || c == ']')
+            {
+                depth--;
+                continue;
+            }
+            if (c != '"' || i + 1 >= count)
+                continue;
+
+            // Skip over the string, and check if it names a member of the top-level object
+            const uint32_t open = positions[i];
+            const uint32_t close = positions[++i];
+            if (depth != 1 || i + 2 >= count || chars[positions[i + 1]] != ':')
+                continue;
+            const qsizetype keyIndex = keys.indexOf(QByteArrayView(chars + open + 1, close - open - 1));
+            if (keyIndex < 0 || !values[keyIndex].isNull())
+                continue;
+
+            const uint32_t colon = positions[i + 1];
+            const size_t first = i + 2;
+            const char next = chars[positions[first]];
+            if (next == '"')
+            {
+                if (first + 1 >= count)
+                    break;
+                values[keyIndex] = QByteArrayView(chars + positions[first], positions[first + 1] + 1 - positions[first]);
+            }
+            else if (next == '{' || next == '[')
+            {
+                // Nested values are found by bracket matching, the walk carries on from the
+                // opening bracket so the depth stays right.
+                int nested = 0;
+                for (size_t last = first; last < count; last++)
+                {
+                    const char s = chars[positions[last]];
+                    if (s == '{' || s == '[')
+                        nested++;
+                    else if ((s == '}' || s == ']') && --nested == 0)
+                    {
+                        values[keyIndex] = QByteArrayView(chars + positions[first], positions[last] + 1 - positions[first]);
+                        break;
+                    }
+                }
+                if (values[keyIndex].isNull())
+                    break;
+            }
+            else
+            {
+                // Number or literal, it spans up to the next structural character
+                const char* begin = chars + colon + 1;
+                const char* end = chars + positions[first];
+                while (begin < end && IsSpace(*begin))
+                    begin++;
+                while (end > begin && IsSpace(*(end - 1)))
+                    end--;
+                values[keyIndex] = QByteArrayView(begin, end - begin);
+            }
+            found++;
+        }
+        return found;
+    }
+
+    bool FindEventKey(QByteArrayView line, QByteArrayView& key)
+    {
+        return FindHeaderString(line, "\"k\"", key);
+    }
+
+    bool FindTimestamp(QByteArrayView line, QByteArrayView& ts)
+    {
+        return FindHeaderString(line, "\"ts\"", ts);
+    }
+
+    bool ToDouble(QByteArrayView number, double& value)
+    {
+        QJsonValue decoded;
+        if (!DecodeLiteral(number.data(), number.data() + number.size(), decoded) || !decoded.isDouble())
+            return false;
+        value = decoded.toDouble();
+        return true;
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef EVENTPARSER_H
+#define EVENTPARSER_H
+
+#include <QByteArrayView>
+#include <QJsonObject>
+#include <QList>
+
+#include <cstdint>
+#include <vector>
+
+// Parser specialized for Tableau log lines, which are one JSON object per line with a small set of
+// top-level keys (ts, pid, tid, sev, req, sess, site, user, k, a, e, v).
+// It first locates all structural characters of the line with SIMD compares, 64 bytes at a time,
+// in the style of simdjson. The top-level object is then walked over these positions: scalar
+// values are decoded directly, and nested objects/arrays are located by bracket matching and
+// handed to the Qt parser as a slice.
+namespace EventParser
+{
+    // Parses a line holding a JSON object into obj.
+    // Returns false if the line isn't something this parser handles (including malformed JSON).
+    // The caller should then fall back to QJsonDocument::fromJson.
+    // If rawValue is given, an object or array under the "v" key is not parsed. It is left out of
+    // obj and rawValue is set to its bytes instead.
+    bool ParseObject(QByteArrayView line, QJsonObject& obj, QByteArrayView* rawValue = nullptr);
+
+    // Finds the values of top-level keys in the JSON object held by data, without parsing it.
+    // values[i] is set to the raw bytes of the value of keys[i], or left null if the key isn't
+    // found. Strings are returned with their quotes. Returns the number of keys found.
+    int FindMembers(QByteArrayView data, const QList<QByteArrayView>& keys, QList<QByteArrayView>& values);
+
+    // Finds the value of the top-level "k" key of an event line with a plain byte scan, without
+    // parsing the line. Returns false when it can't tell cheaply, e.g. when "k" comes after a
+    // nested value or the key contains escapes.
+    bool FindEventKey(QByteArrayView line, QByteArrayView& key);
+
+    // Finds the value of the top-level "ts" key the same way, for reading the time of a line
+    // without parsing it.
+    bool FindTimestamp(QByteArrayView line, QByteArrayView& ts);
+
+    // Converts a JSON number to a double
+    bool ToDouble(QByteArrayView number, double& value);
+
+    // Fills positions with the offsets of all structural characters in data: the quotes that
+    // open and close strings, and { } [ ] : , outside of strings.
+    // Returns false if data ends inside a string.
+    bool FindStructurals(QByteArrayView data, std::vector<uint32_t>& positions);
+}
+
+#endif // EVENTPARSER_H
@@ -0,0 +1,126 @@
+#include "filesnapshot.h"
+
+#include "eventloader.h"
+
+#include <QCryptographicHash>
+#include <QFile>
+
+#ifdef Q_OS_WIN32
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace
+{
+    // Enough to cover the first lines of a log, which hold the time it was started
+    const qsizetype HeadSize = 4096;
+}
+
+FileSnapshot::FileSnapshot(const QString& fileName)
+    : m_fileName(fileName)
+{
+}
+
+FileSnapshot::FileSnapshot(const QString& path, const LogSource& source, qsizetype offset)
+    : m_fileName(source.FileName())
+    , m_fileId(FileId(path))
+    , m_size(source.Data().size())
+    , m_offset(offset)
+    , m_headChecksum(HeadChecksum(source.Data().first(offset)))
+{
+}
+
+const QString& FileSnapshot::FileName() const
+{
+    return m_fileName;
+}
+
+FileSnapshot::Change FileSnapshot::Compare(const QString& path, const LogSource& source) const
+{
+    const QByteArrayView data = source.Data();
+    if (m_size < 0 || data.size() < m_offset || FileId(path) != m_fileId)
+        return Change::Replaced;
+    if (HeadChecksum(data.first(m_offset)) != m_headChecksum)
+        return Change::Replaced;
+    return (data.size() == m_size) ? Change::None : Change::Appended;
+}
+
+void FileSnapshot::Advance(const LogSource& source, qsizetype offset, int lineCount)
+{
+    NextIndex(source);
+    m_size = source.Data().size();
+    m_offset = offset;
+    m_nextIndex += lineCount;
+    // The head grows with the file until it reaches HeadSize
+    m_headChecksum = HeadChecksum(source.Data().first(offset));
+}
+
+void FileSnapshot::Advance(QFile& file, qsizetype offset, int lineCount)
+{
+    if (m_size < 0)
+        return;
+
+    // A file that was replaced or truncated has been read again from its start
+    const quint64 fileId = FileId(file.fileName());
+    const bool restarted = fileId != m_fileId || offset < m_offset;
+    if (restarted)
+        m_nextIndex = 1 + lineCount;
+    else if (m_nextIndex != 0)
+        m_nextIndex += lineCount;
+    // Otherwise the lines are counted up to the new offset when first needed
+
+    m_fileId = fileId;
+    m_size = file.size();
+    if (restarted || m_offset < HeadSize)
+    {
+        // The head grows with the file until it reaches HeadSize
+        const qint64 pos = file.pos();
+        file.seek(0);
+        m_headChecksum = HeadChecksum(file.read(qMin(offset, HeadSize)));
+        file.seek(pos);
+    }
+    m_offset = offset;
+}
+
+qsizetype FileSnapshot::Offset() const
+{
+    return m_offset;
+}
+
+int FileSnapshot::NextIndex(const LogSource& source)
+{
+    if (m_nextIndex == 0)
+    {
+        // Counting at load would hold up the first screen for a refresh that may never come
+        m_nextIndex = 1 + EventLoader::CountLines(source.Data().first(m_offset));
+    }
+    return m_nextIndex;
+}
+
+quint64 FileSnapshot::FileId(const QString& path)
+{
+#ifdef Q_OS_WIN32
+    HANDLE handle = CreateFileW(reinterpret_cast<LPCWSTR>(path.utf16()), 0,
+                                FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE)
+        return 0;
+    BY_HANDLE_FILE_INFORMATION info;
+    quint64 id = 0;
+    if (GetFileInformationByHandle(handle, &info))
+        id = (static_cast<quint64>(info.nFileIndexHigh) << 32) | info.nFileIndexLow;
+    CloseHandle(handle);
+    return id;
+#else
+    struct stat st;
+    if (stat(QFile::encodeName(path).constData(), &st) != 0)
+        return 0;
+    return static_cast<quint64>(st.st_ino);
+#endif
+}
+
+QByteArray FileSnapshot::HeadChecksum(QByteArrayView data)
+{
+    return QCryptographicHash::hash(data.first(qMin(data.size(), HeadSize)), QCryptographicHash::Sha1);
+}
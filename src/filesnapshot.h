@@ -0,0 +1,58 @@
+#ifndef FILESNAPSHOT_H
+#define FILESNAPSHOT_H
+
+#include "logsource.h"
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+
+// Remembers how much of a log file has been loaded, and what the file looked like then, so a
+// refresh can tell whether the file only grew or was replaced.
+// A file is identified by its inode (file index on Windows), and by a checksum of its first bytes
+// for file systems that reuse inodes or rewrite files in place.
+// Files that are not read through a LogSource (compressed files, archive members) only record
+// the file name of their events, and are always reloaded in full.
+class FileSnapshot
+{
+public:
+    enum class Change
+    {
+        None,
+        Appended,
+        Replaced
+    };
+
+    FileSnapshot() = default;
+    explicit FileSnapshot(const QString& fileName);
+    // The first offset bytes of the data of source have been loaded as events
+    FileSnapshot(const QString& path, const LogSource& source, qsizetype offset);
+
+    // The file name the events of the file were loaded with
+    const QString& FileName() const;
+    Change Compare(const QString& path, const LogSource& source) const;
+    // Records that the bytes up to offset were loaded, as lineCount more lines
+    void Advance(const LogSource& source, qsizetype offset, int lineCount);
+    // The same for a file that live capture reads through file, which must be open
+    void Advance(QFile& file, qsizetype offset, int lineCount);
+
+    // Where to continue reading, and the index of the next line there.
+    // Lines are only counted when first needed, source is the file being read.
+    qsizetype Offset() const;
+    int NextIndex(const LogSource& source);
+
+    // The inode or file index of path, 0 if it doesn't exist
+    static quint64 FileId(const QString& path);
+
+private:
+    static QByteArray HeadChecksum(QByteArrayView data);
+
+    QString m_fileName;
+    quint64 m_fileId = 0;
+    qsizetype m_size = -1;
+    qsizetype m_offset = 0;
+    int m_nextIndex = 0;
+    QByteArray m_headChecksum;
+};
+
+#endif // FILESNAPSHOT_H
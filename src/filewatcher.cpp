@@ -0,0 +1,199 @@
+#include "filewatcher.h"
+
+#include "filesnapshot.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QStorageInfo>
+
+#ifdef Q_OS_WIN32
+#include <windows.h>
+#endif
+
+namespace
+{
+    // Upper bound on how often changes are reported, and on the latency added by coalescing
+    const int FlushInterval = 100;
+    const int FallbackInterval = 2000;
+
+    // Network file systems don't pass on the changes made by other machines
+    bool IsNetworkPath(const QString& path)
+    {
+        if (path.startsWith("//") || path.startsWith("\\\\"))
+            return true;
+#ifdef Q_OS_WIN32
+        // Mapped network drives report the file system of the server
+        const QString root = QStorageInfo(path).rootPath();
+        if (GetDriveTypeW(reinterpret_cast<LPCWSTR>(root.utf16())) == DRIVE_REMOTE)
+            return true;
+#endif
+        static const QSet<QByteArray> networkTypes = {
+            "nfs", "nfs4", "cifs", "smb", "smbfs", "smb2", "smb3", "afpfs", "webdav", "fuse.sshfs", "9p"
+        };
+        return networkTypes.contains(QStorageInfo(path).fileSystemType().toLower());
+    }
+}
+
+FileWatcher::FileWatcher(QObject *parent)
+    : QObject(parent)
+{
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(FlushInterval);
+    m_fallbackTimer.setInterval(FallbackInterval);
+    connect(&m_watcher, &QFileSystemWatcher::fileChanged, this, &FileWatcher::OnFileChanged);
+    connect(&m_watcher, &QFileSystemWatcher::directoryChanged, this, &FileWatcher::OnDirectoryChanged);
+    connect(&m_flushTimer, &QTimer::timeout, this, &FileWatcher::Flush);
+    connect(&m_fallbackTimer, &QTimer::timeout, this, &FileWatcher::OnFallbackCheck);
+}
+
+void FileWatcher::AddFile(const QString& path)
+{
+    if (m_files.contains(path))
+        return;
+    m_files.insert(path);
+    Watch(path);
+}
+
+void FileWatcher::RemoveFile(const QString& path)
+{
+    if (!m_files.remove(path))
+        return;
+    m_polled.remove(path);
+    if (m_watchedFiles.remove(path))
+        m_watcher.removePath(path);
+    m_rewatch.remove(path);
+    m_pendingFiles.remove(path);
+}
+
+void FileWatcher::AddDirectory(const QString& path)
+{
+    if (m_directories.contains(path))
+        return;
+    m_directories.insert(path);
+    Watch(path);
+}
+
+void FileWatcher::RemoveDirectory(const QString& path)
+{
+    if (m_directories.remove(path) && !m_polled.remove(path))
+        m_watcher.removePath(path);
+    m_pendingDirectories.remove(path);
+}
+
+FileWatcher::PollState FileWatcher::CurrentState(const QString& path)
+{
+    QFileInfo fi(path);
+    if (!fi.exists())
+        return {};
+    return { fi.isDir() ? 0 : fi.size(), fi.lastModified().toMSecsSinceEpoch() };
+}
+
+bool FileWatcher::IsOnNetwork(const QString& path)
+{
+    // Looked up once per directory, QStorageInfo reads the mount table
+    const QFileInfo fi(path);
+    const QString directory = fi.isDir() ? path : fi.path();
+    auto it = m_networkDirectories.constFind(directory);
+    if (it == m_networkDirectories.constEnd())
+        it = m_networkDirectories.insert(directory, IsNetworkPath(directory));
+    return *it;
+}
+
+void FileWatcher::Watch(const QString& path)
+{
+    const bool isFile = !m_directories.contains(path);
+    const bool watched = !IsOnNetwork(path) && m_watcher.addPath(path);
+    if (watched && isFile)
+        m_watchedFiles.insert(path, FileSnapshot::FileId(path));
+#ifdef Q_OS_WIN32
+    if (watched && !isFile)
+        return;
+#else
+    if (watched)
+        return;
+#endif
+
+    m_polled.insert(path, CurrentState(path));
+    if (!m_fallbackTimer.isActive())
+        m_fallbackTimer.start();
+}
+
+void FileWatcher::Clear()
+{
+    if (!m_watcher.files().isEmpty())
+        m_watcher.removePaths(m_watcher.files());
+    if (!m_watcher.directories().isEmpty())
+        m_watcher.removePaths(m_watcher.directories());
+    m_files.clear();
+    m_directories.clear();
+    m_watchedFiles.clear();
+    m_rewatch.clear();
+    m_polled.clear();
+    m_networkDirectories.clear();
+    m_pendingFiles.clear();
+    m_pendingDirectories.clear();
+    m_flushTimer.stop();
+    m_fallbackTimer.stop();
+}
+
+void FileWatcher::OnFileChanged(const QString& path)
+{
+    // A file that was removed or replaced drops out of the watcher, whatever has its path now is
+    // watched once the change is reported
+    auto watched = m_watchedFiles.find(path);
+    if (watched != m_watchedFiles.end() && FileSnapshot::FileId(path) != *watched)
+    {
+        m_watcher.removePath(path);
+        m_watchedFiles.erase(watched);
+        m_rewatch.insert(path);
+    }
+
+    m_pendingFiles.insert(path);
+    if (!m_flushTimer.isActive())
+        m_flushTimer.start();
+}
+
+void FileWatcher::OnDirectoryChanged(const QString& path)
+{
+    m_pendingDirectories.insert(path);
+    if (!m_flushTimer.isActive())
+        m_flushTimer.start();
+}
+
+void FileWatcher::OnFallbackCheck()
+{
+    // Only what looks different is reported, the files are not read to find out
+    for (auto it = m_polled.begin(); it != m_polled.end(); ++it)
+    {
+        const PollState state = CurrentState(it.key());
+        if (state.size == it->size && state.modified == it->modified)
+            continue;
+        *it = state;
+        if (m_directories.contains(it.key()))
+            m_pendingDirectories.insert(it.key());
+        else
+            m_pendingFiles.insert(it.key());
+    }
+    Flush();
+}
+
+void FileWatcher::Flush()
+{
+    m_flushTimer.stop();
+    if (m_pendingFiles.isEmpty() && m_pendingDirectories.isEmpty())
+        return;
+
+    // A file that isn't there yet is polled until it comes back
+    for (const QString& path : m_rewatch)
+    {
+        m_polled.remove(path);
+        Watch(path);
+    }
+    m_rewatch.clear();
+
+    QStringList files(m_pendingFiles.begin(), m_pendingFiles.end());
+    QStringList directories(m_pendingDirectories.begin(), m_pendingDirectories.end());
+    m_pendingFiles.clear();
+    m_pendingDirectories.clear();
+    emit changed(files, directories);
+}
@@ -0,0 +1,70 @@
+#ifndef FILEWATCHER_H
+#define FILEWATCHER_H
+
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QTimer>
+
+// Tells a live capture which of its files were written to, and when files were added to its
+// directory, so it doesn't have to poll all of them.
+// Built on QFileSystemWatcher, which uses inotify on Linux and the native notifications elsewhere.
+// Bursts of notifications are coalesced: changed paths are collected and reported together at
+// most once per interval. Directories are reported one by one, so only the ones that changed need
+// to be listed again. A file that was replaced is watched again under the same path.
+// Paths that can't be watched, and paths on network shares, which don't report every change, are
+// polled instead: their size and modification time are checked every few seconds. On Windows,
+// files are polled that way as well as watched, a write to a file its writer keeps open is often
+// only reported once the writer's cache is flushed.
+class FileWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FileWatcher(QObject *parent = nullptr);
+
+    void AddFile(const QString& path);
+    void RemoveFile(const QString& path);
+    void AddDirectory(const QString& path);
+    void RemoveDirectory(const QString& path);
+    void Clear();
+
+signals:
+    // files are the watched files that may have new content, directories the watched directories
+    // whose entries may have changed
+    void changed(const QStringList& files, const QStringList& directories);
+
+private:
+    void OnFileChanged(const QString& path);
+    void OnDirectoryChanged(const QString& path);
+    void OnFallbackCheck();
+    void Flush();
+    void Watch(const QString& path);
+
+    struct PollState
+    {
+        qint64 size = -1;
+        qint64 modified = 0;
+    };
+    static PollState CurrentState(const QString& path);
+    bool IsOnNetwork(const QString& path);
+
+    QFileSystemWatcher m_watcher;
+    // The files added to m_watcher, with the file id they had then
+    QHash<QString, quint64> m_watchedFiles;
+    // Files that the watcher dropped because they were removed or replaced
+    QSet<QString> m_rewatch;
+    // The paths that are polled, with what they looked like at the last check
+    QHash<QString, PollState> m_polled;
+    QHash<QString, bool> m_networkDirectories;
+    QSet<QString> m_files;
+    QSet<QString> m_directories;
+    QSet<QString> m_pendingFiles;
+    QSet<QString> m_pendingDirectories;
+    QTimer m_flushTimer;
+    QTimer m_fallbackTimer;
+};
+
+#endif // FILEWATCHER_H
@@ -0,0 +1,199 @@
+#include "gzipreader.h"
+
+#include <QDebug>
+#include <QFileInfo>
+#include <QMutexLocker>
+
+#ifdef USE_QT_ZLIB
+#include <QtZlib/zlib.h>
+#else
+#include <zlib.h>
+#endif
+
+namespace
+{
+    // Compressed bytes read from the file at a time
+    const qint64 InputChunkSize = 256 * 1024;
+    // Room made in the output block for every call to inflate()
+    const qsizetype OutputChunkSize = 1024 * 1024;
+    // Decompressed blocks are cut at the first line end after this size
+    const qsizetype BlockSize = 8 * 1024 * 1024;
+    // Blocks decompressed ahead of the parser
+    const int MaxQueuedBlocks = 4;
+}
+
+GzipReader::GzipReader(const QString& path)
+    : m_file(path)
+{
+}
+
+GzipReader::~GzipReader()
+{
+    Cancel();
+    if (m_thread)
+    {
+        m_thread->wait();
+    }
+}
+
+bool GzipReader::IsGzipFile(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QByteArray magic = file.read(2);
+    return magic.size() == 2 && static_cast<uchar>(magic[0]) == 0x1f && static_cast<uchar>(magic[1]) == 0x8b;
+}
+
+bool GzipReader::Start()
+{
+    if (!m_file.open(QIODevice::ReadOnly))
+        return false;
+
+    m_compressedSize = m_file.size();
+    m_thread.reset(QThread::create([this]() { Run(); }));
+    m_thread->start();
+    return true;
+}
+
+void GzipReader::Cancel()
+{
+    m_cancelled = true;
+    QMutexLocker locker(&m_mutex);
+    m_blockTaken.wakeAll();
+    m_blockReady.wakeAll();
+}
+
+bool GzipReader::NextBlock(QByteArray& block)
+{
+    QMutexLocker locker(&m_mutex);
+    while (m_blocks.isEmpty() && !m_done && !m_cancelled)
+    {
+        m_blockReady.wait(&m_mutex);
+    }
+    if (m_blocks.isEmpty() || m_cancelled)
+        return false;
+
+    block = m_blocks.dequeue();
+    m_blockTaken.wakeOne();
+    return true;
+}
+
+bool GzipReader::HasError() const
+{
+    return m_error;
+}
+
+QString GzipReader::FileName() const
+{
+    return QFileInfo(m_file.fileName()).fileName();
+}
+
+int GzipReader::GetProgress() const
+{
+    if (m_compressedSize <= 0)
+        return 0;
+    return static_cast<int>(m_compressedPos * 100 / m_compressedSize);
+}
+
+bool GzipReader::PushBlock(QByteArray block)
+{
+    QMutexLocker locker(&m_mutex);
+    while (m_blocks.size() >= MaxQueuedBlocks && !m_cancelled)
+    {
+        m_blockTaken.wait(&m_mutex);
+    }
+    if (m_cancelled)
+        return false;
+
+    m_blocks.enqueue(std::move(block));
+    m_blockReady.wakeOne();
+    return true;
+}
+
+void GzipReader::Run()
+{
+    z_stream stream = {};
+    // 15 window bits, +32 to detect the gzip (or zlib) header automatically
+    int status = inflateInit2(&stream, 15 + 32);
+    bool ok = (status == Z_OK);
+
+    QByteArray input(InputChunkSize, Qt::Uninitialized);
+    QByteArray pending;
+    pending.reserve(BlockSize + OutputChunkSize);
+    bool streamEnded = false;
+    bool outputFull = false;
+    while (ok && !m_cancelled)
+    {
+        // When the output filled up, inflate() may still hold data without needing more input
+        if (stream.avail_in == 0 && !outputFull)
+        {
+            qint64 read = m_file.read(input.data(), input.size());
+            if (read <= 0)
+                break;
+            m_compressedPos += read;
+            stream.next_in = reinterpret_cast<Bytef*>(input.data());
+            stream.avail_in = static_cast<uInt>(read);
+        }
+        if (streamEnded)
+        {
+            // Concatenated archives (e.g. from "cat a.gz b.gz") hold several gzip members
+            inflateReset(&stream);
+            streamEnded = false;
+        }
+
+        // Inflate straight into the tail of the pending block
+        const qsizetype used = pending.size();
+        pending.resize(used + OutputChunkSize);
+        stream.next_out = reinterpret_cast<Bytef*>(pending.data() + used);
+        stream.avail_out = static_cast<uInt>(OutputChunkSize);
+        status = inflate(&stream, Z_NO_FLUSH);
+        pending.resize(used + OutputChunkSize - stream.avail_out);
+        outputFull = (stream.avail_out == 0);
+
+        if (status == Z_STREAM_END)
+        {
+            streamEnded = true;
+        }
+        else if (status != Z_OK && status != Z_BUF_ERROR)
+        {
+            qWarning() << "Failed to decompress" << m_file.fileName() << (stream.msg ? stream.msg : "");
+            ok = false;
+            break;
+        }
+
+        if (pending.size() >= BlockSize)
+        {
+            qsizetype eol = pending.lastIndexOf('\n');
+            if (eol >= 0)
+            {
+                QByteArray rest;
+                rest.reserve(BlockSize + OutputChunkSize);
+                rest.append(pending.constData() + eol + 1, pending.size() - eol - 1);
+                pending.truncate(eol + 1);
+                if (!PushBlock(std::move(pending)))
+                    break;
+                pending = std::move(rest);
+            }
+        }
+    }
+
+    if (ok && !streamEnded && !m_cancelled)
+    {
+        qWarning() << "Unexpected end of compressed data in" << m_file.fileName();
+        ok = false;
+    }
+    inflateEnd(&stream);
+
+    // Whatever was decompressed is still handed out, even if the archive turned out to be damaged
+    if (!pending.isEmpty() && !m_cancelled)
+    {
+        PushBlock(std::move(pending));
+    }
+
+    m_error = !ok;
+    QMutexLocker locker(&m_mutex);
+    m_done = true;
+    m_blockReady.wakeAll();
+}
@@ -0,0 +1,57 @@
+#ifndef GZIPREADER_H
+#define GZIPREADER_H
+
+#include <atomic>
+#include <memory>
+#include <QByteArray>
+#include <QFile>
+#include <QMutex>
+#include <QQueue>
+#include <QString>
+#include <QThread>
+#include <QWaitCondition>
+
+// Decompresses a gzip file on a background thread.
+// The decompressed content is handed out in blocks that end on a line boundary, so every block
+// can go straight to the parser while the next one is being inflated. Only a few blocks are
+// buffered ahead of the parser, which keeps memory bounded for multi-GB archives.
+class GzipReader
+{
+public:
+    explicit GzipReader(const QString& path);
+    ~GzipReader();
+
+    GzipReader(const GzipReader&) = delete;
+    GzipReader& operator=(const GzipReader&) = delete;
+
+    static bool IsGzipFile(const QString& path);
+
+    bool Start();
+    void Cancel();
+    // Waits for the next block of decompressed lines. Returns false once the whole file was read.
+    bool NextBlock(QByteArray& block);
+    bool HasError() const;
+    QString FileName() const;
+    // Percentage of the compressed file consumed so far
+    int GetProgress() const;
+
+private:
+    void Run();
+    bool PushBlock(QByteArray block);
+
+    QFile m_file;
+    qint64 m_compressedSize = 0;
+    std::atomic<qint64> m_compressedPos { 0 };
+    std::atomic_bool m_cancelled { false };
+    std::atomic_bool m_error { false };
+
+    QMutex m_mutex;
+    QWaitCondition m_blockReady;
+    QWaitCondition m_blockTaken;
+    QQueue<QByteArray> m_blocks;
+    bool m_done = false;
+
+    std::unique_ptr<QThread> m_thread;
+};
+
+#endif // GZIPREADER_H
@@ -0,0 +1,280 @@
+#include "logevent.h"
+
+#include "stringpool.h"
+
+#include <limits>
+#include <QJsonArray>
+#include <QJsonDocument>
+
+namespace
+{
+    // Keys of the string fields, in the order of LogEvent::Field
+    const QLatin1String FieldKeys[] = {
+        QLatin1String("file"),
+        QLatin1String("k"),
+        QLatin1String("sev"),
+        QLatin1String("tid"),
+        QLatin1String("req"),
+        QLatin1String("sess"),
+        QLatin1String("site"),
+        QLatin1String("user"),
+    };
+}
+
+LogEvent::LogEvent(const QJsonObject& object)
+{
+    SetHeader(object);
+}
+
+LogEvent::LogEvent(const QJsonObject& header, QByteArrayView rawValue)
+    : m_rawValue(rawValue.toByteArray())
+    , m_valueSize(static_cast<qint32>(rawValue.size()))
+{
+    SetHeader(header);
+}
+
+LogEvent::LogEvent(const QJsonObject& header, const LogSourcePtr& source, QByteArrayView rawValue)
+    : m_source(source)
+    , m_valueOffset(rawValue.data() - source->Data().data())
+    , m_valueSize(static_cast<qint32>(rawValue.size()))
+{
+    SetHeader(header);
+}
+
+int LogEvent::FieldIndex(const QString& key)
+{
+    for (int i = 0; i < FieldCount; i++)
+    {
+        if (key == FieldKeys[i])
+            return i;
+    }
+    return -1;
+}
+
+bool LogEvent::IsInterned(int field)
+{
+    return field != Request && field != Session;
+}
+
+void LogEvent::SetHeader(const QJsonObject& header)
+{
+    for (auto it = header.begin(); it != header.end(); ++it)
+    {
+        const QString key = it.key();
+        const QJsonValue value = it.value();
+        if (value.isString())
+        {
+            int field = FieldIndex(key);
+            if (field >= 0 && !IsInterned(field))
+            {
+                m_fields[field] = StringPool::Uninterned;
+                m_ids[field - Request] = value.toString();
+                continue;
+            }
+            if (field >= 0)
+            {
+                m_fields[field] = StringPool::Intern(value.toString());
+                if (m_fields[field] != StringPool::Uninterned)
+                    continue;
+                // The pool is full, the string is kept with the other members
+            }
+            if (key == QLatin1String("ts"))
+            {
+                m_ts = value.toString();
+                m_flags |= HasTime;
+                continue;
+            }
+        }
+        else if (value.isDouble())
+        {
+            // Anything that doesn't fit in an int keeps its JSON form
+            const qint64 number = value.toInteger(std::numeric_limits<qint64>::min());
+            const bool isInt = number >= std::numeric_limits<qint32>::min() && number <= std::numeric_limits<qint32>::max();
+            if (isInt && key == QLatin1String("idx"))
+            {
+                m_index = static_cast<qint32>(number);
+                m_flags |= HasIndex;
+                continue;
+            }
+            if (isInt && key == QLatin1String("pid"))
+            {
+                m_pid = static_cast<qint32>(number);
+                m_flags |= HasPid;
+                continue;
+            }
+        }
+        m_extra.insert(key, value);
+    }
+}
+
+bool LogEvent::isEmpty() const
+{
+    if (m_flags != 0 || HasPendingValue() || !m_extra.isEmpty())
+        return false;
+    for (quint32 code : m_fields)
+    {
+        if (code != StringPool::Null)
+            return false;
+    }
+    return true;
+}
+
+bool LogEvent::contains(const QString& key) const
+{
+    if (HasPendingValue() && key == QLatin1String("v"))
+        return true;
+    int field = FieldIndex(key);
+    if (field >= 0 && m_fields[field] != StringPool::Null)
+        return true;
+    if ((m_flags & HasTime) && key == QLatin1String("ts"))
+        return true;
+    if ((m_flags & HasIndex) && key == QLatin1String("idx"))
+        return true;
+    if ((m_flags & HasPid) && key == QLatin1String("pid"))
+        return true;
+    return m_extra.contains(key);
+}
+
+QJsonValue LogEvent::value(const QString& key) const
+{
+    if (HasPendingValue() && key == QLatin1String("v"))
+        return Value();
+    int field = FieldIndex(key);
+    if (field >= 0 && m_fields[field] != StringPool::Null)
+        return FieldString(static_cast<Field>(field));
+    if ((m_flags & HasTime) && key == QLatin1String("ts"))
+        return m_ts;
+    if ((m_flags & HasIndex) && key == QLatin1String("idx"))
+        return m_index;
+    if ((m_flags & HasPid) && key == QLatin1String("pid"))
+        return m_pid;
+    return m_extra.value(key);
+}
+
+QJsonValue LogEvent::operator[](const QString& key) const
+{
+    return value(key);
+}
+
+bool LogEvent::HasPendingValue() const
+{
+    return m_valueSize > 0;
+}
+
+QByteArrayView LogEvent::RawValue() const
+{
+    if (m_source)
+    {
+        // Empty if the file was truncated before it was copied, see LogSource::Detach()
+        const QByteArrayView data = m_source->Data();
+        if (m_valueOffset + m_valueSize > data.size())
+            return QByteArrayView();
+        return data.sliced(m_valueOffset, m_valueSize);
+    }
+    return m_rawValue;
+}
+
+QJsonValue LogEvent::Value() const
+{
+    if (!HasPendingValue())
+        return m_extra.value("v");
+
+    // fromRawData() reads the bytes in place, out of the mapping when there is one
+    QByteArrayView raw = RawValue();
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(QByteArray::fromRawData(raw.data(), raw.size()), &parseError);
+    if (parseError.error != QJsonParseError::NoError)
+    {
+        // The payload was only bracket matched at load. Show it as is rather than losing it.
+        return QString::fromUtf8(raw);
+    }
+    if (doc.isArray())
+        return doc.array();
+    return doc.object();
+}
+
+QJsonObject LogEvent::Header() const
+{
+    QJsonObject header = m_extra;
+    for (int i = 0; i < FieldCount; i++)
+    {
+        if (m_fields[i] != StringPool::Null)
+            header.insert(FieldKeys[i], FieldString(static_cast<Field>(i)));
+    }
+    if (m_flags & HasTime)
+        header.insert("ts", m_ts);
+    if (m_flags & HasIndex)
+        header.insert("idx", m_index);
+    if (m_flags & HasPid)
+        header.insert("pid", m_pid);
+    return header;
+}
+
+QJsonObject LogEvent::ToObject() const
+{
+    QJsonObject obj = Header();
+    if (HasPendingValue())
+    {
+        obj.insert("v", Value());
+    }
+    return obj;
+}
+
+qint32 LogEvent::Index() const
+{
+    return m_index;
+}
+
+void LogEvent::SetIndex(qint32 index)
+{
+    m_index = index;
+    m_flags |= HasIndex;
+}
+
+qint32 LogEvent::Pid() const
+{
+    return m_pid;
+}
+
+const QString& LogEvent::Timestamp() const
+{
+    return m_ts;
+}
+
+quint32 LogEvent::FieldCode(Field field) const
+{
+    return m_fields[field];
+}
+
+QString LogEvent::FieldString(Field field) const
+{
+    const quint32 code = m_fields[field];
+    if (code != StringPool::Uninterned)
+        return StringPool::Get(code);
+    if (!IsInterned(field))
+        return m_ids[field - Request];
+    return m_extra.value(FieldKeys[field]).toString();
+}
+
+qint64 LogEvent::ValueOffset() const
+{
+    return (m_source && !(m_flags & IsSpilled)) ? m_valueOffset : -1;
+}
+
+LogSourcePtr LogEvent::FileSource() const
+{
+    return (m_flags & IsSpilled) ? nullptr : m_source;
+}
+
+qsizetype LogEvent::HeldValueSize() const
+{
+    return m_source ? 0 : m_rawValue.size();
+}
+
+void LogEvent::SpillValue(const LogSourcePtr& source, qint64 offset)
+{
+    m_source = source;
+    m_valueOffset = offset;
+    m_rawValue = QByteArray();
+    m_flags |= IsSpilled;
+}
@@ -0,0 +1,108 @@
+#ifndef LOGEVENT_H
+#define LOGEVENT_H
+
+#include "logsource.h"
+
+#include <memory>
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QString>
+
+typedef std::shared_ptr<const LogSource> LogSourcePtr;
+
+// A single log event.
+// Events are stored as compact records rather than JSON objects: the common header fields
+// (file, k, sev, tid, ...) are interned codes, idx and pid are integers, and anything else
+// in the header is kept in a small JSON object on the side. Request and session ids are
+// different for almost every request, so they are kept as strings rather than interned.
+// When values are parsed on demand, "v" stays as raw JSON bytes until something asks for it.
+// Events read from a mapped file only keep the position of those bytes, and the value is
+// rehydrated from the mapping, which stays alive as long as one of its events does. The mapping
+// is swapped for a copy when the file may change, see LogSource::Detach().
+// The lower case accessors mirror QJsonObject so events can be read the same way.
+class LogEvent
+{
+public:
+    LogEvent() = default;
+    LogEvent(const QJsonObject& object);
+    LogEvent(const QJsonObject& header, QByteArrayView rawValue);
+    // rawValue is a view into the data of source
+    LogEvent(const QJsonObject& header, const LogSourcePtr& source, QByteArrayView rawValue);
+
+    bool isEmpty() const;
+    bool contains(const QString& key) const;
+    QJsonValue value(const QString& key) const;
+    QJsonValue operator[](const QString& key) const;
+
+    // True if "v" hasn't been parsed yet
+    bool HasPendingValue() const;
+    QByteArrayView RawValue() const;
+    QJsonValue Value() const;
+    // Every member but a pending "v"
+    QJsonObject Header() const;
+    QJsonObject ToObject() const;
+
+    // Offset of the raw value in the mapped file it is read from, or -1 if it is held in memory
+    // or has been spilled
+    qint64 ValueOffset() const;
+    // The log file the raw value is read from, null if it is held in memory or has been spilled
+    LogSourcePtr FileSource() const;
+    // Bytes of a pending value held in memory, which is what spilling it would free
+    qsizetype HeldValueSize() const;
+    // Moves a pending value held in memory out to source, where it has been written at offset.
+    // It is read back through the mapping of source from then on.
+    void SpillValue(const LogSourcePtr& source, qint64 offset);
+
+    enum Field
+    {
+        File,
+        Key,
+        Severity,
+        Thread,
+        Request,
+        Session,
+        Site,
+        User,
+        FieldCount
+    };
+
+    // Direct access to the header fields, without going through QJsonValue.
+    // Missing fields read as 0, or as StringPool::Null for the interned ones.
+    qint32 Index() const;
+    void SetIndex(qint32 index);
+    qint32 Pid() const;
+    const QString& Timestamp() const;
+    // StringPool::Uninterned for a field that is kept as a string, see FieldString()
+    quint32 FieldCode(Field field) const;
+    QString FieldString(Field field) const;
+
+private:
+    enum Flag : quint8
+    {
+        HasIndex = 0x1,
+        HasPid = 0x2,
+        HasTime = 0x4,
+        IsSpilled = 0x8
+    };
+
+    static int FieldIndex(const QString& key);
+    static bool IsInterned(int field);
+    void SetHeader(const QJsonObject& header);
+
+    LogSourcePtr m_source;
+    QByteArray m_rawValue;
+    qint64 m_valueOffset = -1;
+    qint32 m_valueSize = 0;
+    qint32 m_index = 0;
+    qint32 m_pid = 0;
+    quint8 m_flags = 0;
+    quint32 m_fields[FieldCount] = {};
+    // Request and Session
+    QString m_ids[2];
+    QString m_ts;
+    QJsonObject m_extra;
+};
+
+#endif // LOGEVENT_H
@@ -0,0 +1,513 @@
+#include "logindex.h"
+
+#include "options.h"
+#include "pathhelper.h"
+
+#include <atomic>
+#include <cstring>
+#include <limits>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QtConcurrent>
+#include <QtEndian>
+
+namespace
+{
+    const quint32 Magic = 0x49564c54; // "TLVI"
+    // Bump whenever the layout below or the way events are parsed changes
+    const quint32 Version = 2;
+
+    // Files smaller than this parse about as fast as their index would load
+    const qint64 MinFileSize = 32 * 1024 * 1024;
+    // Events per block. Blocks are decoded concurrently.
+    const qint64 BlockEventCount = 16384;
+    // Nesting allowed in header values, which are flat in practice
+    const int MaxDepth = 64;
+    // The cache folder is pruned to this, oldest indexes first. Indexes unused for MaxCacheAge
+    // days are removed whatever the size.
+    const qint64 MaxCacheSize = 2048LL * 1024 * 1024;
+    const int MaxCacheAge = 30;
+
+    // Layout:
+    //   records   one per event: value offset (i64), value length (u32), header object
+    //   metadata  file path, skipped keys, key table, block offsets
+    //   footer    fixed size, see below
+    // Objects are a count followed by (key id, value) pairs. Values start with a ValueType.
+    const qsizetype FooterSize = 44;
+
+    enum ValueType : quint8
+    {
+        Null = 0,
+        False,
+        True,
+        Integer,
+        Double,
+        String,
+        Array,
+        Object
+    };
+
+    template <typename T>
+    void Put(QByteArray& out, T value)
+    {
+        const T le = qToLittleEndian(value);
+        out.append(reinterpret_cast<const char*>(&le), sizeof(T));
+    }
+
+    void PutBytes(QByteArray& out, QByteArrayView bytes)
+    {
+        Put<quint32>(out, static_cast<quint32>(bytes.size()));
+        out.append(bytes.data(), bytes.size());
+    }
+
+    // Bounds-checked reading. Once anything is out of bounds, ok is false and all reads return 0.
+    struct Reader
+    {
+        const char* pos;
+        const char* end;
+        bool ok = true;
+
+        template <typename T>
+        T Get()
+        {
+            if (!ok || end - pos < static_cast<qsizetype>(sizeof(T)))
+            {
+                ok = false;
+                return T();
+            }
+            T value = qFromLittleEndian<T>(pos);
+            pos += sizeof(T);
+            return value;
+        }
+
+        QByteArrayView GetBytes()
+        {
+            const quint32 size = Get<quint32>();
+            if (!ok || static_cast<quint64>(end - pos) < size)
+            {
+                ok = false;
+                return QByteArrayView();
+            }
+            QByteArrayView bytes(pos, size);
+            pos += size;
+            return bytes;
+        }
+    };
+
+    QJsonValue ReadValue(Reader& reader, const QStringList& keys, int depth);
+
+    QJsonObject ReadObject(Reader& reader, const QStringList& keys, int depth)
+    {
+        QJsonObject obj;
+        const quint32 count = reader.Get<quint32>();
+        for (quint32 i = 0; i < count && reader.ok; i++)
+        {
+            const quint32 keyId = reader.Get<quint32>();
+            if (keyId >= static_cast<quint32>(keys.size()))
+            {
+                reader.ok = false;
+                break;
+            }
+            obj.insert(keys[keyId], ReadValue(reader, keys, depth + 1));
+        }
+        return obj;
+    }
+
+    QJsonValue ReadValue(Reader& reader, const QStringList& keys, int depth)
+    {
+        if (depth > MaxDepth)
+        {
+            reader.ok = false;
+            return QJsonValue();
+        }
+
+        switch (reader.Get<quint8>())
+        {
+        case ValueType::Null:
+            return QJsonValue();
+        case ValueType::False:
+            return false;
+        case ValueType::True:
+            return true;
+        case ValueType::Integer:
+            return reader.Get<qint64>();
+        case ValueType::Double:
+        {
+            const quint64 bits = reader.Get<quint64>();
+            double value;
+            std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+        case ValueType::String:
+        {
+            QByteArrayView bytes = reader.GetBytes();
+            return QString::fromUtf8(bytes.data(), bytes.size());
+        }
+        case ValueType::Array:
+        {
+            QJsonArray array;
+            const quint32 count = reader.Get<quint32>();
+            for (quint32 i = 0; i < count && reader.ok; i++)
+            {
+                array.append(ReadValue(reader, keys, depth + 1));
+            }
+            return array;
+        }
+        case ValueType::Object:
+            return ReadObject(reader, keys, depth);
+        default:
+            reader.ok = false;
+            return QJsonValue();
+        }
+    }
+
+    struct Block
+    {
+        const char* begin;
+        const char* end;
+        qint64 eventCount;
+    };
+}
+
+LogIndex::LogIndex(const QString& path, qint64 fileSize, const ParseSettings& settings)
+    : m_path(path)
+    , m_fileSize(fileSize)
+    , m_skippedKeys(settings.SkippedKeysSignature())
+    , m_deferValueParsing(settings.deferValueParsing)
+{
+}
+
+bool LogIndex::IsWorthIndexing(qint64 fileSize)
+{
+    return fileSize >= MinFileSize && Options::GetInstance().getIndexLargeFiles();
+}
+
+QString LogIndex::IndexPath(const QString& path)
+{
+    QByteArray hash = QCryptographicHash::hash(QFileInfo(path).absoluteFilePath().toUtf8(), QCryptographicHash::Sha1);
+    return PathHelper::GetIndexCachePath() + "/" + QString::fromLatin1(hash.toHex()) + ".idx";
+}
+
+bool LogIndex::Load(const LogSourcePtr& source, const QString& path, const ParseSettings& settings, EventList& events, int& skippedCount)
+{
+    const QByteArrayView data = source->Data();
+    if (!IsWorthIndexing(data.size()))
+        return false;
+    // Events from an index always have their values pending, see Begin()
+    if (!settings.deferValueParsing)
+        return false;
+
+    QFile file(IndexPath(path));
+    if (!file.open(QIODevice::ReadOnly) || file.size() < FooterSize)
+        return false;
+    // The mapping goes away with the file
+    const uchar* mapped = file.map(0, file.size());
+    if (!mapped)
+        return false;
+    const char* const indexBegin = reinterpret_cast<const char*>(mapped);
+    const char* const indexEnd = indexBegin + file.size();
+
+    Reader footer { indexEnd - FooterSize, indexEnd };
+    const quint32 magic = footer.Get<quint32>();
+    const quint32 version = footer.Get<quint32>();
+    const quint64 fileSize = footer.Get<quint64>();
+    const qint64 modified = footer.Get<qint64>();
+    const qint64 eventCount = footer.Get<qint64>();
+    const qint32 indexSkippedCount = footer.Get<qint32>();
+    const quint64 metadataOffset = footer.Get<quint64>();
+    if (!footer.ok || magic != Magic || version != Version || eventCount < 0 ||
+        fileSize != static_cast<quint64>(data.size()) ||
+        modified != QFileInfo(path).lastModified().toMSecsSinceEpoch() ||
+        metadataOffset > static_cast<quint64>(file.size() - FooterSize))
+    {
+        return false;
+    }
+
+    Reader metadata { indexBegin + metadataOffset, indexEnd - FooterSize };
+    const QString indexedPath = QString::fromUtf8(metadata.GetBytes());
+    const QByteArrayView skippedKeys = metadata.GetBytes();
+    if (!metadata.ok || indexedPath != QFileInfo(path).absoluteFilePath() ||
+        skippedKeys != settings.SkippedKeysSignature())
+    {
+        return false;
+    }
+
+    QStringList keys;
+    const quint32 keyCount = metadata.Get<quint32>();
+    for (quint32 i = 0; i < keyCount && metadata.ok; i++)
+    {
+        keys.append(QString::fromUtf8(metadata.GetBytes()));
+    }
+
+    QList<Block> blocks;
+    const quint32 blockCount = metadata.Get<quint32>();
+    for (quint32 i = 0; i < blockCount && metadata.ok; i++)
+    {
+        const quint64 offset = metadata.Get<quint64>();
+        if (offset > metadataOffset || (!blocks.isEmpty() && indexBegin + offset < blocks.last().begin))
+        {
+            metadata.ok = false;
+            break;
+        }
+        if (!blocks.isEmpty())
+        {
+            blocks.last().end = indexBegin + offset;
+        }
+        const qint64 blockEvents = qMin(BlockEventCount, eventCount - i * BlockEventCount);
+        blocks.append({ indexBegin + offset, indexBegin + metadataOffset, blockEvents });
+    }
+    if (!metadata.ok || blockCount != static_cast<quint32>((eventCount + BlockEventCount - 1) / BlockEventCount))
+    {
+        qWarning() << "Ignoring damaged index" << file.fileName();
+        return false;
+    }
+
+    const QString fileName = source->FileName();
+    std::atomic_bool damaged { false };
+    QList<EventList> results = QtConcurrent::blockingMapped<QList<EventList>>(blocks, [&](const Block& block) {
+        EventList blockEvents;
+        blockEvents.reserve(block.eventCount);
+        Reader reader { block.begin, block.end };
+        for (qint64 i = 0; i < block.eventCount && reader.ok; i++)
+        {
+            const qint64 valueOffset = reader.Get<qint64>();
+            const quint32 valueSize = reader.Get<quint32>();
+            QJsonObject header = ReadObject(reader, keys, 0);
+            header.insert("file", fileName);
+            if (valueOffset < 0)
+            {
+                blockEvents.append(header);
+                continue;
+            }
+            if (static_cast<quint64>(valueOffset) + valueSize > static_cast<quint64>(data.size()))
+            {
+                reader.ok = false;
+                break;
+            }
+            // The value stays unparsed, exactly as if the line had just been read
+            blockEvents.append(LogEvent(header, source, data.sliced(valueOffset, valueSize)));
+        }
+        if (!reader.ok)
+        {
+            damaged = true;
+        }
+        return blockEvents;
+    });
+    if (damaged)
+    {
+        qWarning() << "Ignoring damaged index" << file.fileName();
+        return false;
+    }
+
+    events.reserve(events.size() + eventCount);
+    for (EventList& blockEvents : results)
+    {
+        events.append(std::move(blockEvents));
+    }
+    skippedCount += indexSkippedCount;
+    // Recently used indexes are the last to be pruned
+    file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    return true;
+}
+
+bool LogIndex::Begin()
+{
+    // Without deferred parsing values aren't located in the file, they would all have to be
+    // copied into the index
+    if (!m_deferValueParsing)
+    {
+        m_failed = true;
+        return false;
+    }
+
+    QFileInfo fi(m_path);
+    m_modified = fi.lastModified().toMSecsSinceEpoch();
+
+    const QString indexPath = IndexPath(m_path);
+    QDir().mkpath(QFileInfo(indexPath).path());
+    m_file.setFileName(indexPath);
+    if (!m_file.open(QIODevice::WriteOnly))
+    {
+        qWarning() << "Unable to write index" << indexPath;
+        m_failed = true;
+        return false;
+    }
+    return true;
+}
+
+void LogIndex::Append(const EventList& events)
+{
+    if (m_failed)
+        return;
+
+    QByteArray out;
+    for (const LogEvent& event : events)
+    {
+        if (event.HasPendingValue() && event.ValueOffset() < 0)
+        {
+            // The value can't be found again in the file
+            m_failed = true;
+            return;
+        }
+
+        if (m_eventCount % BlockEventCount == 0)
+        {
+            m_blockOffsets.append(m_written + out.size());
+        }
+        m_eventCount++;
+
+        Put<qint64>(out, event.HasPendingValue() ? event.ValueOffset() : -1);
+        Put<quint32>(out, static_cast<quint32>(event.RawValue().size()));
+        // The file name is set again when loading, the index may outlive a rename
+        const QJsonObject header = event.Header();
+        Put<quint32>(out, static_cast<quint32>(header.size() - (header.contains("file") ? 1 : 0)));
+        for (auto it = header.begin(); it != header.end(); ++it)
+        {
+            if (it.key() == QLatin1String("file"))
+                continue;
+            Put<quint32>(out, KeyId(it.key()));
+            WriteValue(out, it.value());
+        }
+    }
+
+    if (m_file.write(out) != out.size())
+    {
+        m_failed = true;
+        return;
+    }
+    m_written += out.size();
+}
+
+bool LogIndex::Commit(int skippedCount)
+{
+    if (m_failed)
+    {
+        m_file.cancelWriting();
+        return false;
+    }
+
+    QByteArray out;
+    PutBytes(out, QFileInfo(m_path).absoluteFilePath().toUtf8());
+    PutBytes(out, m_skippedKeys);
+    Put<quint32>(out, static_cast<quint32>(m_keys.size()));
+    for (const QString& key : m_keys)
+    {
+        PutBytes(out, key.toUtf8());
+    }
+    Put<quint32>(out, static_cast<quint32>(m_blockOffsets.size()));
+    for (quint64 offset : m_blockOffsets)
+    {
+        Put<quint64>(out, offset);
+    }
+
+    Put<quint32>(out, Magic);
+    Put<quint32>(out, Version);
+    Put<quint64>(out, static_cast<quint64>(m_fileSize));
+    Put<qint64>(out, m_modified);
+    Put<qint64>(out, m_eventCount);
+    Put<qint32>(out, skippedCount);
+    Put<quint64>(out, static_cast<quint64>(m_written));
+
+    if (m_file.write(out) != out.size() || !m_file.commit())
+    {
+        qWarning() << "Unable to write index" << m_file.fileName();
+        return false;
+    }
+    PruneCache();
+    return true;
+}
+
+void LogIndex::PruneCache()
+{
+    QDir cacheDir(PathHelper::GetIndexCachePath());
+    const QFileInfoList indexes = cacheDir.entryInfoList({"*.idx"}, QDir::Files, QDir::Time);
+    const QDateTime oldest = QDateTime::currentDateTime().addDays(-MaxCacheAge);
+    qint64 totalSize = 0;
+    for (const QFileInfo& index : indexes)
+    {
+        // Newest first, the ones that don't fit go
+        totalSize += index.size();
+        if (totalSize > MaxCacheSize || index.lastModified() < oldest)
+        {
+            QFile::remove(index.filePath());
+        }
+    }
+}
+
+void LogIndex::WriteObject(QByteArray& out, const QJsonObject& obj)
+{
+    Put<quint32>(out, static_cast<quint32>(obj.size()));
+    for (auto it = obj.begin(); it != obj.end(); ++it)
+    {
+        Put<quint32>(out, KeyId(it.key()));
+        WriteValue(out, it.value());
+    }
+}
+
+void LogIndex::WriteValue(QByteArray& out, const QJsonValue& value)
+{
+    switch (value.type())
+    {
+    case QJsonValue::Bool:
+        Put<quint8>(out, value.toBool() ? ValueType::True : ValueType::False);
+        break;
+    case QJsonValue::Double:
+    {
+        // Whole numbers keep their integer type, as pid and tid come out of the parser
+        const qint64 integer = value.toInteger(std::numeric_limits<qint64>::min());
+        if (integer != std::numeric_limits<qint64>::min())
+        {
+            Put<quint8>(out, ValueType::Integer);
+            Put<qint64>(out, integer);
+        }
+        else
+        {
+            const double number = value.toDouble();
+            quint64 bits;
+            std::memcpy(&bits, &number, sizeof(bits));
+            Put<quint8>(out, ValueType::Double);
+            Put<quint64>(out, bits);
+        }
+        break;
+    }
+    case QJsonValue::String:
+        Put<quint8>(out, ValueType::String);
+        PutBytes(out, value.toString().toUtf8());
+        break;
+    case QJsonValue::Array:
+    {
+        const QJsonArray array = value.toArray();
+        Put<quint8>(out, ValueType::Array);
+        Put<quint32>(out, static_cast<quint32>(array.size()));
+        for (const QJsonValue& item : array)
+        {
+            WriteValue(out, item);
+        }
+        break;
+    }
+    case QJsonValue::Object:
+        Put<quint8>(out, ValueType::Object);
+        WriteObject(out, value.toObject());
+        break;
+    default:
+        Put<quint8>(out, ValueType::Null);
+        break;
+    }
+}
+
+quint32 LogIndex::KeyId(const QString& key)
+{
+    auto it = m_keyIds.constFind(key);
+    if (it != m_keyIds.constEnd())
+        return it.value();
+
+    const quint32 id = static_cast<quint32>(m_keys.size());
+    m_keyIds.insert(key, id);
+    m_keys.append(key);
+    return id;
+}
@@ -0,0 +1,64 @@
+#ifndef LOGINDEX_H
+#define LOGINDEX_H
+
+#include "logsource.h"
+#include "options.h"
+#include "treemodel.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QList>
+#include <QSaveFile>
+#include <QString>
+#include <QStringList>
+
+// Sidecar index of a parsed log file, kept in the cache folder.
+// The index holds the header fields of every event and the position of its value in the file,
+// so an unchanged file can be reopened by mapping it and rebuilding the events without parsing
+// any line. An index is only used for the exact size and modification time of the file it was
+// made from, and for the same skipped keys. The cache folder is kept under a size and age limit.
+//
+// Writing is incremental: Begin(), then Append() for every batch of events in file order, then
+// Commit(). Nothing is left behind if the writer is destroyed before Commit().
+class LogIndex
+{
+public:
+    LogIndex(const QString& path, qint64 fileSize, const ParseSettings& settings);
+
+    LogIndex(const LogIndex&) = delete;
+    LogIndex& operator=(const LogIndex&) = delete;
+
+    // True if a file of this size should get an index, given the current options
+    static bool IsWorthIndexing(qint64 fileSize);
+    // Rebuilds the events of path, whose content is source, from its index.
+    // Returns false, leaving events untouched, if there is no index made with the same settings.
+    static bool Load(const LogSourcePtr& source, const QString& path, const ParseSettings& settings, EventList& events, int& skippedCount);
+
+    bool Begin();
+    void Append(const EventList& events);
+    bool Commit(int skippedCount);
+
+private:
+    static QString IndexPath(const QString& path);
+    static void PruneCache();
+    void WriteObject(QByteArray& out, const QJsonObject& obj);
+    void WriteValue(QByteArray& out, const QJsonValue& value);
+    quint32 KeyId(const QString& key);
+
+    QString m_path;
+    qint64 m_fileSize;
+    qint64 m_modified = 0;
+    QByteArray m_skippedKeys;
+    bool m_deferValueParsing;
+    QSaveFile m_file;
+    bool m_failed = false;
+    qint64 m_written = 0;
+    qint64 m_eventCount = 0;
+    QHash<QString, quint32> m_keyIds;
+    QStringList m_keys;
+    QList<quint64> m_blockOffsets;
+};
+
+#endif // LOGINDEX_H
@@ -0,0 +1,171 @@
+#include "logloader.h"
+
+#include "eventloader.h"
+
+namespace
+{
+    // Size of the blocks handed to the parser. Every block becomes one batch of rows in the
+    // model, so this balances the number of model updates against how often the view refreshes.
+    const qsizetype BlockSize = 8 * 1024 * 1024;
+}
+
+LogLoader::LogLoader(std::shared_ptr<LogSource> source, qsizetype offset, int nextIndex, int skippedCount, const ParseSettings& settings)
+    : m_source(source)
+    , m_settings(settings)
+    , m_offset(offset)
+    , m_end(source->Data().lastIndexOf('\n') + 1)
+    , m_nextIndex(nextIndex)
+    , m_skippedCount(skippedCount)
+{
+}
+
+LogLoader::LogLoader(std::shared_ptr<GzipReader> reader, const ParseSettings& settings)
+    : m_reader(reader)
+    , m_settings(settings)
+{
+}
+
+LogLoader::~LogLoader()
+{
+    Cancel();
+    if (m_thread)
+    {
+        m_thread->wait();
+    }
+}
+
+void LogLoader::WriteIndex(const QString& path, const EventList& headEvents)
+{
+    if (!m_source)
+        return;
+
+    m_index = std::make_unique<LogIndex>(path, m_source->Data().size(), m_settings);
+    if (!m_index->Begin())
+    {
+        m_index.reset();
+        return;
+    }
+    m_index->Append(headEvents);
+}
+
+void LogLoader::Start()
+{
+    m_running = true;
+    m_thread.reset(QThread::create([this]() { Run(); }));
+    m_thread->start();
+}
+
+void LogLoader::Cancel()
+{
+    m_cancelled = true;
+    if (m_reader)
+    {
+        // Wakes up the loader if it is waiting for the next block
+        m_reader->Cancel();
+    }
+}
+
+bool LogLoader::IsRunning() const
+{
+    return m_running;
+}
+
+int LogLoader::GetProgress() const
+{
+    return m_progress;
+}
+
+qint64 LogLoader::GetTotalBytes() const
+{
+    // Only meaningful for uncompressed files, where it is the offset to resume reading from
+    return m_end;
+}
+
+bool LogLoader::HasError() const
+{
+    return m_reader && m_reader->HasError();
+}
+
+void LogLoader::Run()
+{
+    int index = m_nextIndex;
+    int skippedCount = m_skippedCount;
+    if (m_reader)
+    {
+        ReadCompressed(index, skippedCount);
+    }
+    else
+    {
+        ReadMapped(index, skippedCount);
+    }
+
+    if (m_index)
+    {
+        // An index of a partly loaded file would be mistaken for the whole file
+        if (!m_cancelled)
+        {
+            m_index->Commit(skippedCount);
+        }
+        m_index.reset();
+    }
+
+    m_running = false;
+    emit finished(skippedCount, m_cancelled);
+}
+
+void LogLoader::ReadMapped(int& index, int& skippedCount)
+{
+    // A last line without its line break may still be being written, it is left to a refresh
+    const QByteArrayView data = m_source->Data().first(m_end);
+    const QString fileName = m_source->FileName();
+    const qsizetype total = data.size();
+
+    qsizetype pos = m_offset;
+    while (pos < total && !m_cancelled)
+    {
+        qsizetype end = pos + BlockSize;
+        if (end >= total)
+        {
+            end = total;
+        }
+        else
+        {
+            qsizetype eol = data.indexOf('\n', end);
+            end = (eol < 0) ? total : eol + 1;
+        }
+
+        ParseBlock(data.sliced(pos, end - pos), fileName, index, skippedCount);
+        pos = end;
+
+        m_progress = static_cast<int>(pos * 100 / total);
+        emit progressChanged(m_progress);
+    }
+}
+
+void LogLoader::ReadCompressed(int& index, int& skippedCount)
+{
+    const QString fileName = m_reader->FileName();
+    QByteArray block;
+    while (!m_cancelled && m_reader->NextBlock(block))
+    {
+        ParseBlock(block, fileName, index, skippedCount);
+        block.clear();
+
+        m_progress = m_reader->GetProgress();
+        emit progressChanged(m_progress);
+    }
+}
+
+void LogLoader::ParseBlock(QByteArrayView block, const QString& fileName, int& index, int& skippedCount)
+{
+    auto events = std::make_shared<EventList>();
+    index += EventLoader::ParseEvents(block, fileName, index, *events, skippedCount, m_settings, m_source);
+    if (m_index)
+    {
+        m_index->Append(*events);
+    }
+    if (!events->isEmpty())
+    {
+        emit eventsLoaded(events);
+    }
+}
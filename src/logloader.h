@@ -0,0 +1,66 @@
+#ifndef LOGLOADER_H
+#define LOGLOADER_H
+
+#include "gzipreader.h"
+#include "logindex.h"
+#include "logsource.h"
+#include "treemodel.h"
+
+#include <atomic>
+#include <memory>
+#include <QObject>
+#include <QThread>
+
+// Parses the remainder of a log file on a background thread.
+// Events are handed back in batches through eventsLoaded(), so the tab can show the first
+// rows while the rest of the file is still being read.
+// Compressed files are read through a GzipReader, which inflates on its own thread so
+// decompression and parsing overlap.
+// Uncompressed files can be indexed along the way, see LogIndex.
+class LogLoader : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Lines are parsed with settings, a copy of the options taken when the load started
+    LogLoader(std::shared_ptr<LogSource> source, qsizetype offset, int nextIndex, int skippedCount, const ParseSettings& settings);
+    LogLoader(std::shared_ptr<GzipReader> reader, const ParseSettings& settings);
+    ~LogLoader();
+
+    // Saves an index of the whole file once it is loaded. headEvents are the events that were
+    // parsed before the loader's offset. Call before Start().
+    void WriteIndex(const QString& path, const EventList& headEvents);
+    void Start();
+    void Cancel();
+    bool IsRunning() const;
+    int GetProgress() const;
+    qint64 GetTotalBytes() const;
+    // Set once a compressed file turned out to be damaged or truncated, only part of it was loaded
+    bool HasError() const;
+
+signals:
+    void eventsLoaded(EventListPtr events);
+    void progressChanged(int percent);
+    void finished(int skippedCount, bool cancelled);
+
+private:
+    void Run();
+    void ReadMapped(int& index, int& skippedCount);
+    void ReadCompressed(int& index, int& skippedCount);
+    void ParseBlock(QByteArrayView block, const QString& fileName, int& index, int& skippedCount);
+
+    std::shared_ptr<LogSource> m_source;
+    std::shared_ptr<GzipReader> m_reader;
+    std::unique_ptr<LogIndex> m_index;
+    const ParseSettings m_settings;
+    qsizetype m_offset = 0;
+    qsizetype m_end = 0;
+    int m_nextIndex = 1;
+    int m_skippedCount = 0;
+    std::atomic_bool m_cancelled { false };
+    std::atomic_bool m_running { false };
+    std::atomic_int m_progress { 0 };
+    std::unique_ptr<QThread> m_thread;
+};
+
+#endif // LOGLOADER_H
@@ -0,0 +1,96 @@
+#include "logsource.h"
+
+#include <QFileInfo>
+
+LogSource::LogSource(const QString& path)
+    : m_file(path)
+{
+}
+
+LogSource::~LogSource()
+{
+    Close();
+}
+
+bool LogSource::Open()
+{
+    if (!m_file.open(QIODevice::ReadOnly))
+        return false;
+
+    m_size = m_file.size();
+    if (m_size > 0)
+    {
+        m_mapped = m_file.map(0, m_size);
+    }
+
+    if (!m_mapped)
+    {
+        // Fall back to reading the whole file. Sequential devices report a size of 0,
+        // so readAll() is used rather than trusting m_size.
+        m_buffer = m_file.readAll();
+        m_size = m_buffer.size();
+    }
+    return true;
+}
+
+void LogSource::Close()
+{
+    if (m_mapped)
+    {
+        MappedFile().unmap(m_mapped);
+        m_mapped = nullptr;
+    }
+    m_buffer.clear();
+    m_size = 0;
+    m_file.close();
+    m_partOf.reset();
+}
+
+QFile& LogSource::MappedFile() const
+{
+    return m_partOf ? *m_partOf : m_file;
+}
+
+bool LogSource::IsMapped() const
+{
+    return m_mapped != nullptr;
+}
+
+QByteArrayView LogSource::Data() const
+{
+    if (m_mapped)
+        return QByteArrayView(reinterpret_cast<const char*>(m_mapped), m_size);
+    return QByteArrayView(m_buffer);
+}
+
+QString LogSource::FileName() const
+{
+    return QFileInfo(m_file.fileName()).fileName();
+}
+
+std::shared_ptr<LogSource> LogSource::MapPart(const std::shared_ptr<QFile>& file, qint64 offset, qint64 size)
+{
+    auto source = std::make_shared<LogSource>(file->fileName());
+    source->m_mapped = file->map(offset, size);
+    if (!source->m_mapped)
+        return nullptr;
+    source->m_partOf = file;
+    source->m_size = size;
+    return source;
+}
+
+void LogSource::Detach() const
+{
+    // A spill file doesn't change under its events
+    if (!m_mapped || m_partOf)
+        return;
+
+    // The size of the open file, which is the mapped one even if its path now leads elsewhere.
+    // Reading a mapping past the end of its file faults.
+    const qint64 size = qMin(m_size, m_file.size());
+    m_buffer = QByteArray(reinterpret_cast<const char*>(m_mapped), size);
+    m_file.unmap(m_mapped);
+    m_mapped = nullptr;
+    m_size = size;
+    m_file.close();
+}
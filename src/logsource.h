@@ -0,0 +1,87 @@
+#ifndef LOGSOURCE_H
+#define LOGSOURCE_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QFile>
+#include <QString>
+
+#include <cstring>
+#include <memory>
+
+// Gives read-only access to the raw bytes of a log file.
+// The file is memory-mapped when possible so lines can be handed to the parser as views into
+// the mapping, without copying every line into its own QByteArray. If the file cannot be
+// mapped (e.g. it is empty or lives on a device that doesn't support mapping), the content
+// is read into memory instead.
+// Events keep reading their values out of the mapping. A file that may change while its events
+// are shown, as in a live capture, is copied into memory with Detach() first.
+class LogSource
+{
+public:
+    explicit LogSource(const QString& path);
+    ~LogSource();
+
+    LogSource(const LogSource&) = delete;
+    LogSource& operator=(const LogSource&) = delete;
+
+    bool Open();
+    void Close();
+    bool IsMapped() const;
+    QByteArrayView Data() const;
+    QString FileName() const;
+    // Maps size bytes of file from offset, for the temporary file values are spilled to. The source
+    // keeps file open. Returns null if the part can't be mapped.
+    static std::shared_ptr<LogSource> MapPart(const std::shared_ptr<QFile>& file, qint64 offset, qint64 size);
+    // Copies the mapped bytes into memory and closes the file, so it can be truncated or replaced.
+    // Offsets into Data() stay valid. Only the bytes the file still has are copied, the rest of
+    // Data() is lost if it was already truncated. Not to be called while Data() is being read.
+    void Detach() const;
+
+    // Calls func(QByteArrayView line) for every non-empty line in data.
+    // Lines are trimmed of leading and trailing whitespace, same as QByteArray::trimmed().
+    template <typename Func>
+    static void ForEachLine(QByteArrayView data, Func&& func);
+
+private:
+    static bool IsSpace(char c);
+    QFile& MappedFile() const;
+
+    // Detach() changes where the bytes are held, not what they are
+    mutable QFile m_file;
+    mutable uchar* m_mapped = nullptr;
+    mutable qint64 m_size = 0;
+    mutable QByteArray m_buffer;
+    // The file a part of which is mapped, see MapPart()
+    std::shared_ptr<QFile> m_partOf;
+};
+
+inline bool LogSource::IsSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+template <typename Func>
+void LogSource::ForEachLine(QByteArrayView data, Func&& func)
+{
+    const char* pos = data.data();
+    const char* const end = pos + data.size();
+    while (pos < end)
+    {
+        const char* eol = static_cast<const char*>(std::memchr(pos, '\n', end - pos));
+        const char* next = eol ? eol + 1 : end;
+        const char* lineEnd = eol ? eol : end;
+
+        while (pos < lineEnd && IsSpace(*pos))
+            pos++;
+        while (lineEnd > pos && IsSpace(*(lineEnd - 1)))
+            lineEnd--;
+
+        if (lineEnd > pos)
+            func(QByteArrayView(pos, lineEnd - pos));
+
+        pos = next;
+    }
+}
+
+#endif // LOGSOURCE_H
@@ -1,12 +1,16 @@
 #include "logtab.h"
 #include "ui_logtab.h"
 
+#include "eventloader.h"
+#include "filesnapshot.h"
+#include "gzipreader.h"
 #include "options.h"
 #include "pathhelper.h"
-#include "processevent.h"
 #include "themeutils.h"
+#include "timeutils.h"
 #include "treeitem.h"
 #include "valuedlg.h"
+#include "ziparchive.h"
 
 #include <memory>
 #include <initializer_list>
@@ -14,6 +18,7 @@
 #include <QFontDatabase>
 #include <QMenu>
 #include <QJsonDocument>
+#include <QtConcurrent>
 
 LogTab::LogTab(QWidget *parent, StatusBar *bar, const EventListPtr events) :
     QWidget(parent),
@@ -26,8 +31,75 @@ LogTab::LogTab(QWidget *parent, StatusBar *bar, const EventListPtr events) :
     InitMenus();
 }
 
+namespace
+{
+    // Reads the complete lines appended to a file of a directory capture since the last read, and
+    // parses them. Runs on the thread pool. Indices are assigned once the events are merged.
+    EventList ReadNewEvents(const std::shared_ptr<QFile>& file, const ParseSettings& settings)
+    {
+        if (file->pos() > file->size())
+        {
+            file->seek(0);
+        }
+        const qint64 start = file->pos();
+        QByteArray data = file->readAll();
+        const qsizetype end = data.lastIndexOf('\n') + 1;
+        if (end < data.size())
+        {
+            file->seek(start + end);
+            data.truncate(end);
+        }
+
+        EventList events;
+        int skippedCount = 0;
+        EventLoader::ParseEvents(data, QFileInfo(file->fileName()).fileName(), 0, events, skippedCount, settings);
+        return events;
+    }
+
+    // Opens file again when its path leads to another file than the one that is open, as after a
+    // log rotation. The new file is read from its start.
+    void ReopenIfReplaced(QFile& file, quint64& fileId)
+    {
+        const quint64 currentId = FileSnapshot::FileId(file.fileName());
+        if (currentId == 0 || currentId == fileId)
+            return;
+        file.close();
+        if (file.open(QIODevice::ReadOnly))
+        {
+            fileId = currentId;
+        }
+    }
+
+    // A glob with a slash matches the path from the captured directory, one without matches the
+    // file name in any directory. Case is ignored, as on Windows.
+    QList<QRegularExpression> CompileGlobs(const QStringList& globs)
+    {
+        QList<QRegularExpression> regexes;
+        for (const QString& glob : globs)
+        {
+            const QString pattern = QRegularExpression::wildcardToRegularExpression(glob, QRegularExpression::UnanchoredWildcardConversion);
+            const QString prefix = glob.contains('/') ? "^" : "(?:^|/)";
+            regexes.append(QRegularExpression(prefix + pattern + "$", QRegularExpression::CaseInsensitiveOption));
+        }
+        return regexes;
+    }
+
+    bool MatchesGlob(const QList<QRegularExpression>& globs, const QString& relativePath)
+    {
+        for (const QRegularExpression& glob : globs)
+        {
+            if (glob.match(relativePath).hasMatch())
+                return true;
+        }
+        return false;
+    }
+}
+
 LogTab::~LogTab()
 {
+    // Stop the loader before the model it feeds goes away
+    m_loader.reset();
+    m_directoryRead.waitForFinished();
     delete ui;
 }
 
@@ -44,14 +116,7 @@ void LogTab::InitTreeView(const EventListPtr events)
     m_bar->ShowMessage(QString("%1 events loaded").arg(QString::number(m_treeModel->rowCount())), 3000);
 
     // Display only time if all events occured on the same day
-    bool multipleDays = false;
-    if (events->size() >= 2) {
-       QModelIndex idx = ui->treeView->currentIndex();
-       auto firstDatetime = m_treeModel->index(0, COL::Time, idx.parent()).data(Qt::UserRole).toDateTime();
-       auto lastDatetime = m_treeModel->index(m_treeModel->rowCount()-1, COL::Time, idx.parent()).data(Qt::UserRole).toDateTime();
-       multipleDays = firstDatetime.date() != lastDatetime.date();
-    }
-    m_treeModel->SetTimeMode(multipleDays ? TimeMode::GlobalDateTime : TimeMode::GlobalTime);
+    m_treeModel->SetTimeMode(SpansMultipleDays() ? TimeMode::GlobalDateTime : TimeMode::GlobalTime);
 
     bool hasNoKey = (events->size() > 0 && events->at(0)["k"].toString().isEmpty());
 
@@ -83,6 +148,16 @@ void LogTab::InitTreeView(const EventListPtr events)
             this, SLOT(HeaderRightClicked(QPoint)));
 }
 
+bool LogTab::SpansMultipleDays() const
+{
+    if (m_treeModel->rowCount() < 2)
+        return false;
+
+    auto firstDatetime = m_treeModel->index(0, COL::Time).data(Qt::UserRole).toDateTime();
+    auto lastDatetime = m_treeModel->index(m_treeModel->rowCount() - 1, COL::Time).data(Qt::UserRole).toDateTime();
+    return firstDatetime.date() != lastDatetime.date();
+}
+
 void LogTab::SetColumn(COL column, int width, bool isHidden)
 {
     ui->treeView->setColumnWidth(column, width);
@@ -297,7 +372,6 @@ void LogTab::SetTabPath(const QString& path)
     if (m_treeModel->TabType() == TABTYPE::Directory)
     {
         m_liveDirectory = std::make_unique<QDir>(path);
-        m_liveDirectory->setNameFilters(QStringList({"*.txt", "*.log"}));
     }
     else if (m_treeModel->TabType() == TABTYPE::SingleFile)
     {
@@ -310,58 +384,69 @@ QString LogTab::GetTabPath() const
     return m_tabPath;
 }
 
-void LogTab::SetUpTimer()
+void LogTab::SetUpWatcher()
+{
+    // Files are read when they are written to, rather than polled
+    connect(&m_watcher, &FileWatcher::changed, this, &LogTab::OnFilesChanged, Qt::UniqueConnection);
+    connect(&m_directoryRead, &QFutureWatcher<EventList>::finished, this, &LogTab::DirectoryReadFinished, Qt::UniqueConnection);
+    // The directories of a directory capture are added as they are scanned
+    if (m_treeModel->TabType() == TABTYPE::SingleFile)
+    {
+        m_watcher.AddFile(m_logFile.fileName());
+    }
+}
+
+void LogTab::OnFilesChanged(const QStringList& changedFiles, const QStringList& changedDirectories)
 {
     if (m_treeModel->TabType() == TABTYPE::Directory)
     {
-        connect(&m_timer, &QTimer::timeout, this, &LogTab::ReadDirectoryFiles);
+        ReadDirectoryFiles(changedFiles, changedDirectories);
     }
     else if (m_treeModel->TabType() == TABTYPE::SingleFile)
     {
-        connect(&m_timer, &QTimer::timeout, this, &LogTab::ReadFile);
+        ReadFile();
     }
-    m_timer.start(250);
 }
 
-void LogTab::SetUpFile(std::shared_ptr<QFile> file)
+// Starts following a file of a directory capture. Files that aren't logs are remembered as
+// excluded. A file that can't be opened is tried again the next time its directory changes.
+void LogTab::SetUpFile(std::shared_ptr<QFile> file, bool fromStart)
 {
-    if (!file->exists())
+    // Files are read in binary mode, see ReadNewEvents
+    if (!file->open(QIODevice::ReadOnly))
     {
-        QErrorMessage errorDialog(this);
-        errorDialog.showMessage("File doesn't exist");
-        errorDialog.exec();
-        return;
-    }
-    if (!file->open(QIODevice::ReadOnly | QIODevice::Text))
-    {
-        QErrorMessage errorDialog(this);
-        errorDialog.showMessage("File could not be opened");
-        errorDialog.exec();
+        qWarning() << "Unable to open" << file->fileName() << "for live capture";
         return;
     }
 
     QByteArray line;
     while (!file->atEnd())
     {
-        line = file->readLine();
-        if (line.isEmpty() || line.startsWith("\n"))
+        line = file->readLine().trimmed();
+        if (line.isEmpty())
         {
             continue;
         }
         break;
     }
 
+    // A log that was just created may have nothing in it yet
     bool includeAllTextFiles = Options::GetInstance().getCaptureAllTextFiles();
-    if (includeAllTextFiles || line.startsWith("{"))
+    if (includeAllTextFiles || line.startsWith("{") || (fromStart && line.isEmpty()))
     {
-        int offset = file->size();
-        file->seek(offset);
+        file->seek(fromStart ? 0 : file->size());
         m_directoryFiles[file->fileName()] = file;
+        m_directoryFileIds[file->fileName()] = FileSnapshot::FileId(file->fileName());
+        m_watcher.AddFile(file->fileName());
+        if (fromStart)
+        {
+            m_addedFiles.insert(file->fileName());
+        }
     }
     else
     {
         file->close();
-        m_excludedFileNames.append(file->fileName());
+        m_excludedFileNames.insert(file->fileName());
     }
 }
 
@@ -370,59 +455,189 @@ void LogTab::StartDirectoryLiveCapture()
     SetColumn(COL::File, 110, false);
     m_eventIndex = 1;
     m_treeModel->m_liveMode = true;
-    QStringList files = m_liveDirectory->entryList(QDir::Files);
-    for (const QString& fileName : files)
-    {
-        QString fullPath = m_liveDirectory->path() + "/" + fileName;
-        std::shared_ptr<QFile> file = std::make_shared<QFile>(fullPath);
-        SetUpFile(file);
-    }
-    SetUpTimer();
+
+    const Options& options = Options::GetInstance();
+    m_includeGlobs = CompileGlobs(options.getLiveCaptureIncludeGlobs());
+    m_excludeGlobs = CompileGlobs(options.getLiveCaptureExcludeGlobs());
+    m_recursiveCapture = options.getLiveCaptureRecursive();
+
+    SetUpWatcher();
+    // Only what is written from now on is captured from the files that are there already
+    WatchDirectory(m_liveDirectory->path(), false);
+}
+
+void LogTab::WatchDirectory(const QString& path, bool fromStart)
+{
+    m_directoryEntries.insert(path, QSet<QString>());
+    m_watcher.AddDirectory(path);
+    ScanDirectory(path, fromStart);
 }
 
-void LogTab::ReadDirectoryFiles()
+// Lists one directory of a directory capture. Files it doesn't know yet are followed if they match
+// the globs, files that are gone are forgotten, and new subdirectories are watched when capturing
+// recursively. The cost is that of the directory, not of the whole tree.
+void LogTab::ScanDirectory(const QString& path, bool fromStart)
 {
-    QStringList files = m_liveDirectory->entryList(QDir::Files);
-    if (files.size() > m_directoryFiles.size() + m_excludedFileNames.size())
+    QDir dir(path);
+    if (!dir.exists())
     {
-        for (const QString& fileName : files)
-        {
-            QString fullPath = m_liveDirectory->path() + "/" + fileName;
-            if (!m_directoryFiles.keys().contains(fullPath) && !m_excludedFileNames.contains(fullPath))
-            {
-                std::shared_ptr<QFile> file = std::make_shared<QFile>(fullPath);
-                SetUpFile(file);
-            }
-        }
+        ForgetDirectory(path);
+        return;
     }
 
-    EventList newEvents;
-    for (QString filePath : m_directoryFiles.keys())
+    QSet<QString> entries;
+    const QFileInfoList infos = dir.entryInfoList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QFileInfo& info : infos)
     {
-        std::shared_ptr<QFile> file = m_directoryFiles[filePath];
-        if (file->pos() > file->size())
+        const QString entryPath = info.filePath();
+        const QString relativePath = m_liveDirectory->relativeFilePath(entryPath);
+        if (MatchesGlob(m_excludeGlobs, relativePath))
         {
-            file->seek(0);
+            continue;
         }
-        QStringList filePathList = filePath.split("/");
-        auto& fileName = filePathList.at(filePathList.length() - 1);
-        while (!file->atEnd())
+        if (info.isDir())
         {
-            auto line = file->readLine().trimmed();
-            if (line.isEmpty())
+            if (m_recursiveCapture && !m_directoryEntries.contains(entryPath))
             {
-                continue;
+                WatchDirectory(entryPath, fromStart);
             }
-            QJsonObject jsonObj = ProcessEvent::ProcessLogEventMessage(m_eventIndex, line, fileName);
-            if (jsonObj.isEmpty())
+            continue;
+        }
+
+        entries.insert(entryPath);
+        if (m_directoryFiles.contains(entryPath))
+        {
+            // A log that was rotated away leaves a new file under its name, see ReadDirectoryFiles
+            if (FileSnapshot::FileId(entryPath) != m_directoryFileIds.value(entryPath))
             {
-                continue;
+                m_addedFiles.insert(entryPath);
             }
-            newEvents.append(jsonObj);
-            m_eventIndex++;
+            continue;
+        }
+        if (m_excludedFileNames.contains(entryPath))
+        {
+            continue;
+        }
+        if (MatchesGlob(m_includeGlobs, relativePath))
+        {
+            SetUpFile(std::make_shared<QFile>(entryPath), fromStart);
+        }
+        else
+        {
+            m_excludedFileNames.insert(entryPath);
         }
     }
 
+    // A file that shows up again under the same name later is a new file
+    for (const QString& entryPath : m_directoryEntries.value(path))
+    {
+        if (!entries.contains(entryPath))
+        {
+            ForgetFile(entryPath);
+        }
+    }
+    m_directoryEntries.insert(path, entries);
+}
+
+void LogTab::ForgetFile(const QString& path)
+{
+    std::shared_ptr<QFile> file = m_directoryFiles.take(path);
+    if (file)
+    {
+        file->close();
+        m_watcher.RemoveFile(path);
+    }
+    m_directoryFileIds.remove(path);
+    m_excludedFileNames.remove(path);
+    m_addedFiles.remove(path);
+}
+
+void LogTab::ForgetDirectory(const QString& path)
+{
+    QStringList directories;
+    const QString prefix = path + "/";
+    for (auto it = m_directoryEntries.cbegin(); it != m_directoryEntries.cend(); ++it)
+    {
+        if (it.key() == path || it.key().startsWith(prefix))
+        {
+            directories.append(it.key());
+        }
+    }
+    for (const QString& directory : directories)
+    {
+        for (const QString& entryPath : m_directoryEntries.take(directory))
+        {
+            ForgetFile(entryPath);
+        }
+        m_watcher.RemoveDirectory(directory);
+    }
+}
+
+void LogTab::ReadDirectoryFiles(const QStringList& changedFiles, const QStringList& changedDirectories)
+{
+    if (m_directoryRead.isRunning())
+    {
+        // The files are in use by the running read, pick the changes up once it is done
+        m_pendingChangedFiles.unite(QSet<QString>(changedFiles.begin(), changedFiles.end()));
+        m_pendingChangedDirectories.unite(QSet<QString>(changedDirectories.begin(), changedDirectories.end()));
+        return;
+    }
+
+    // Only the directories where something was added, removed or renamed are listed again.
+    // The files found there are read from their start.
+    for (const QString& directory : changedDirectories)
+    {
+        if (m_directoryEntries.contains(directory))
+        {
+            ScanDirectory(directory, true);
+        }
+    }
+    QSet<QString> readPaths(changedFiles.begin(), changedFiles.end());
+    readPaths.unite(m_addedFiles);
+    m_addedFiles.clear();
+
+    QList<std::shared_ptr<QFile>> readFiles;
+    for (const QString& filePath : readPaths)
+    {
+        std::shared_ptr<QFile> file = m_directoryFiles.value(filePath);
+        if (file)
+        {
+            ReopenIfReplaced(*file, m_directoryFileIds[filePath]);
+            readFiles.append(file);
+        }
+    }
+    if (readFiles.isEmpty())
+    {
+        return;
+    }
+
+    // Each file is read and parsed by a task of the thread pool. The GUI thread only merges.
+    // The tasks get their own copy of the parse settings, the options may change while they run.
+    const ParseSettings settings = Options::GetInstance().GetParseSettings();
+    m_directoryRead.setFuture(QtConcurrent::mapped(readFiles, [settings](const std::shared_ptr<QFile>& file) {
+        return ReadNewEvents(file, settings);
+    }));
+}
+
+void LogTab::DirectoryReadFinished()
+{
+    if (!m_treeModel->m_liveMode || m_directoryRead.isCanceled())
+    {
+        return;
+    }
+
+    const QList<EventList> results = m_directoryRead.future().results();
+    QList<const EventList*> lists;
+    for (const EventList& events : results)
+    {
+        lists.append(&events);
+    }
+    EventList newEvents = EventLoader::MergeSorted(lists);
+    for (LogEvent& event : newEvents)
+    {
+        event.SetIndex(m_eventIndex++);
+    }
+
     if (newEvents.count() > 0)
     {
         bool firstEntries = (m_treeModel->rowCount() == 0);
@@ -446,6 +661,16 @@ void LogTab::ReadDirectoryFiles()
             ui->treeView->ResizeColumns();
         }
     }
+
+    // Changes reported while the files were being read
+    if (!m_pendingChangedFiles.isEmpty() || !m_pendingChangedDirectories.isEmpty())
+    {
+        QStringList changedFiles(m_pendingChangedFiles.begin(), m_pendingChangedFiles.end());
+        QStringList changedDirectories(m_pendingChangedDirectories.begin(), m_pendingChangedDirectories.end());
+        m_pendingChangedFiles.clear();
+        m_pendingChangedDirectories.clear();
+        ReadDirectoryFiles(changedFiles, changedDirectories);
+    }
 }
 
 void LogTab::UpdateModelView()
@@ -478,51 +703,87 @@ bool LogTab::StartFileLiveCapture()
         errorDialog.exec();
         return false;
     }
-    if (!m_logFile.open(QIODevice::ReadOnly | QIODevice::Text))
+    if (GzipReader::IsGzipFile(m_logFile.fileName()) || ZipArchive::IsZipFile(m_logFile.fileName()))
+    {
+        QErrorMessage errorDialog(this);
+        errorDialog.showMessage("Live capture is not available for compressed files");
+        errorDialog.exec();
+        return false;
+    }
+    // Opened in binary mode so positions are byte offsets, ReadFile() seeks back by them.
+    // The line endings are trimmed by the parser.
+    if (!m_logFile.open(QIODevice::ReadOnly))
     {
         QErrorMessage errorDialog(this);
         errorDialog.showMessage("File could not be opened");
         errorDialog.exec();
         return false;
     }
-    int offset = m_logFile.size();
+    // The loaded events stop reading their values out of the file, which may now be truncated
+    // or rotated while the tab shows it
+    m_treeModel->DetachFiles();
+    // Continue right after the bytes read by the background loader, if the tab was opened
+    // with one. Otherwise only new content is captured.
+    qint64 offset = (m_liveStartOffset >= 0) ? m_liveStartOffset : m_logFile.size();
+    m_liveStartOffset = -1;
     m_logFile.seek(offset);
+    m_logFileId = FileSnapshot::FileId(m_logFile.fileName());
 
-    // Set up timer to update/read lines
-    SetUpTimer();
+    SetUpWatcher();
     m_treeModel->m_liveMode = true;
     return true;
 }
 
 void LogTab::ReadFile()
 {
-    const QModelIndex idx;
-    EventList newEvents;
+    ReopenIfReplaced(m_logFile, m_logFileId);
     if (m_logFile.pos() > m_logFile.size())
     {
         m_logFile.seek(0);
     }
-    while (!m_logFile.atEnd())
+
+    // Take every complete line written since the last read. A line still being written is left
+    // for the next read.
+    const qint64 start = m_logFile.pos();
+    QByteArray data = m_logFile.readAll();
+    const qsizetype end = data.lastIndexOf('\n') + 1;
+    if (end < data.size())
     {
-        auto line = m_logFile.readLine().trimmed();
-        if (line.isEmpty())
-        {
-            continue;
-        }
-        QJsonObject jsonObj = ProcessEvent::ProcessLogEventMessage(m_eventIndex, line, m_logFile.fileName());
-        if (jsonObj.isEmpty())
-        {
-            continue;
-        }
-        newEvents.append(jsonObj);
-        m_treeModel->AddToModelData(newEvents);
-        newEvents.clear();
+        m_logFile.seek(start + end);
+        data.truncate(end);
+    }
+    if (data.isEmpty())
+    {
+        return;
+    }
 
-        int offset = m_treeModel->rowCount() - 1;
-        bool hidden = m_treeModel->m_highlightOnlyMode && !m_treeModel->IsHighlightedRow(offset);
-        ui->treeView->setRowHidden(offset, idx, hidden);
+    // The whole burst is parsed and inserted as one batch
+    EventList newEvents;
+    int skippedCount = 0;
+    const int lineCount = EventLoader::ParseEvents(data, m_logFile.fileName(), m_eventIndex, newEvents, skippedCount, Options::GetInstance().GetParseSettings());
+    m_eventIndex += lineCount;
+    // A refresh continues after the lines read here rather than adding them again
+    auto snapshot = m_treeModel->m_fileSnapshots.find(m_logFile.fileName());
+    if (snapshot != m_treeModel->m_fileSnapshots.end())
+    {
+        snapshot->Advance(m_logFile, m_logFile.pos(), lineCount);
+    }
+    if (newEvents.isEmpty())
+    {
+        return;
+    }
 
-        m_eventIndex++;
+    const int firstRow = m_treeModel->rowCount();
+    m_treeModel->AddToModelData(newEvents);
+    if (m_treeModel->m_highlightOnlyMode)
+    {
+        // New rows start out visible, only the ones to hide are touched
+        const QModelIndex idx;
+        for (int row = firstRow; row < m_treeModel->rowCount(); row++)
+        {
+            if (!m_treeModel->IsHighlightedRow(row))
+                ui->treeView->setRowHidden(row, idx, true);
+        }
     }
     TrimEventCount();
     UpdateModelView();
@@ -536,6 +797,14 @@ bool LogTab::StartLiveCapture()
     if (m_treeModel->m_liveMode)
         return true;
 
+    if (IsLoading())
+    {
+        // Live capture continues from where the loader stops, so start it once loading is done
+        m_deferredLiveCapture = true;
+        m_treeModel->m_liveMode = true;
+        return true;
+    }
+
     if (m_treeModel->TabType() == TABTYPE::SingleFile)
     {
         return StartFileLiveCapture();
@@ -551,6 +820,13 @@ bool LogTab::StartLiveCapture()
 
 void LogTab::EndLiveCapture()
 {
+    if (m_deferredLiveCapture)
+    {
+        m_deferredLiveCapture = false;
+        m_treeModel->m_liveMode = false;
+        return;
+    }
+
     if (m_treeModel != nullptr && m_treeModel->m_liveMode)
     {
         m_treeModel->m_liveMode = false;
@@ -560,25 +836,28 @@ void LogTab::EndLiveCapture()
         }
         else if (m_treeModel->TabType() == TABTYPE::Directory)
         {
+            m_directoryRead.cancel();
+            m_directoryRead.waitForFinished();
+            m_pendingChangedFiles.clear();
+            m_pendingChangedDirectories.clear();
             for (std::shared_ptr<QFile> file : m_directoryFiles)
             {
                 file->close();
             }
             m_directoryFiles.clear();
+            m_directoryFileIds.clear();
             m_excludedFileNames.clear();
+            m_directoryEntries.clear();
+            m_addedFiles.clear();
         }
-        m_timer.stop();
+        m_watcher.Clear();
     }
 }
 
 void LogTab::TrimEventCount()
 {
-    const static int MaxEventCount = 100000;
-    int rowCount = m_treeModel->rowCount();
-    if (rowCount > MaxEventCount)
-    {
-        m_treeModel->removeRows(0, rowCount - MaxEventCount);
-    }
+    const Options& options = Options::GetInstance();
+    m_treeModel->TrimOldestRows(options.getLiveEventLimit(), qint64(options.getLiveMemoryLimit()) * 1024 * 1024);
 }
 
 void LogTab::RowDoubleClicked(const QModelIndex& idx)
@@ -815,16 +1094,10 @@ void LogTab::ExportToNewTab(COL column)
     QString name = QString(GetColumnName(column)) + " " + sortedValues.join(",");
 
     // Generate the index list
-    const int count = m_treeModel->rowCount();
-    const QModelIndex root;
     QModelIndexList exportedIdxList;
-    for (int i = 0; i < count; ++i)
+    for (int row : m_treeModel->FindRows(column, exportedValues))
     {
-        auto idx = m_treeModel->index(i, column, root);
-        auto value = idx.data().toString();
-        if (exportedValues.contains(value)) {
-            exportedIdxList.append(idx);
-        }
+        exportedIdxList.append(m_treeModel->index(row, column));
     }
 
     emit exportToTab(exportedIdxList, name);
@@ -955,16 +1228,9 @@ void LogTab::RowHideSelectedType()
        QString key = idx.model()->index(idx.row(), COL::Key, idx.parent()).data().toString();
        hiddenKeys.insert(key);
     }
-    int count = 0;
-    for (const auto& key : hiddenKeys) {
-       auto match = m_treeModel->match(m_treeModel->index(0, COL::Key), Qt::DisplayRole, key, 1, Qt::MatchExactly);
-       while (match.length() > 0)
-       {
-           m_treeModel->removeRow(match[0].row());
-           match = m_treeModel->match(m_treeModel->index(match[0].row(), COL::Key), Qt::DisplayRole, key, 1, Qt::MatchExactly);
-           ++count;
-       }
-    }
+    QList<int> rows = m_treeModel->FindRows(COL::Key, hiddenKeys);
+    int count = rows.size();
+    m_treeModel->RemoveTopLevelRows(rows);
     ui->treeView->setUpdatesEnabled(true);
     menuUpdateNeeded();
 
@@ -1092,8 +1358,12 @@ void LogTab::RowShowGlobalTime()
 void LogTab::RowShowTimeDeltas()
 {
     QModelIndex idx = ui->treeView->currentIndex();
-    auto datetime = idx.model()->index(idx.row(), COL::Time, idx.parent()).data(Qt::UserRole).toDateTime().toMSecsSinceEpoch();
-    m_treeModel->ShowDeltas(datetime);
+    while (idx.parent().isValid())
+        idx = idx.parent();
+    qint64 usecs = m_treeModel->TimeUSecs(idx.row());
+    if (usecs == TimeUtils::InvalidTime)
+        return;
+    m_treeModel->ShowDeltas(usecs);
 }
 
 void LogTab::InitHeaderMenu()
@@ -1153,6 +1423,15 @@ void LogTab::HeaderItemSelected(QAction *action)
 
 void LogTab::UpdateStatusBar()
 {
+    if (IsLoading())
+    {
+        m_bar->ShowProgress(m_loader->GetProgress());
+    }
+    else
+    {
+        m_bar->HideProgress();
+    }
+
     QString status = "";
     if (m_treeModel->HasHighlightFilters())
     {
@@ -1229,6 +1508,95 @@ void LogTab::RefilterTreeView()
     ui->treeView->scrollTo(previousIdx, QAbstractItemView::PositionAtCenter);
 }
 
+void LogTab::StartBackgroundLoad(std::unique_ptr<LogLoader> loader)
+{
+    m_loader = std::move(loader);
+    connect(m_loader.get(), &LogLoader::eventsLoaded, this, &LogTab::AddLoadedEvents);
+    connect(m_loader.get(), &LogLoader::progressChanged, this, &LogTab::LoadProgressChanged);
+    connect(m_loader.get(), &LogLoader::finished, this, &LogTab::LoadFinished);
+    m_loader->Start();
+    m_bar->ShowProgress(0);
+}
+
+void LogTab::CancelLoad()
+{
+    if (m_loader)
+    {
+        m_loader->Cancel();
+    }
+}
+
+bool LogTab::IsLoading() const
+{
+    return m_loader != nullptr;
+}
+
+void LogTab::AddLoadedEvents(EventListPtr events)
+{
+    int first = m_treeModel->rowCount();
+    m_treeModel->AddToModelData(*events);
+
+    if (m_treeModel->m_highlightOnlyMode)
+    {
+        const QModelIndex idx;
+        for (int i = first; i < m_treeModel->rowCount(); i++)
+        {
+            bool hidden = !m_treeModel->IsHighlightedRow(i);
+            ui->treeView->setRowHidden(i, idx, hidden);
+        }
+    }
+}
+
+void LogTab::LoadProgressChanged(int percent)
+{
+    if (isVisible())
+    {
+        m_bar->ShowProgress(percent);
+    }
+}
+
+void LogTab::LoadFinished(int skippedCount, bool cancelled)
+{
+    qint64 loadedBytes = m_loader->GetTotalBytes();
+    bool damaged = m_loader->HasError();
+    // finished is delivered through the event loop, so the loader's thread has already returned
+    m_loader.reset();
+
+    if (damaged)
+    {
+        QMessageBox::warning(this, tr("File partly loaded"),
+                             tr("\"%1\" is damaged or truncated. Only the %2 events before the damage were loaded.")
+                             .arg(QFileInfo(m_tabPath).fileName(), QString::number(m_treeModel->rowCount())));
+    }
+
+    if (isVisible())
+    {
+        m_bar->HideProgress();
+        QString message = cancelled ?
+            QString("Loading cancelled: %1 events loaded; %2 events skipped") :
+            QString("%1 events loaded; %2 events skipped");
+        m_bar->ShowMessage(message.arg(QString::number(m_treeModel->rowCount()), QString::number(skippedCount)), 3000);
+    }
+
+    if (m_treeModel->GetTimeMode() == TimeMode::GlobalTime && SpansMultipleDays())
+    {
+        m_treeModel->SetTimeMode(TimeMode::GlobalDateTime);
+    }
+
+    if (m_deferredLiveCapture)
+    {
+        m_deferredLiveCapture = false;
+        m_treeModel->m_liveMode = false;
+        if (!cancelled)
+        {
+            m_liveStartOffset = loadedBytes;
+        }
+        StartLiveCapture();
+    }
+
+    emit menuUpdateNeeded();
+}
+
 TreeModel* LogTab::GetTreeModel()
 {
    return m_treeModel;
@@ -1,13 +1,18 @@
 #ifndef LOGTAB_H
 #define LOGTAB_H
 
+#include "filewatcher.h"
+#include "logloader.h"
 #include "options.h"
 #include "statusbar.h"
 #include "treemodel.h"
 #include "valuedlg.h"
 
+#include <QFutureWatcher>
 #include <QJsonObject>
 #include <QMenu>
+#include <QRegularExpression>
+#include <QSet>
 #include <QWidget>
 
 
@@ -30,6 +35,9 @@ public:
     void CopyFullPath();
     void ShowInFolder();
     void RefilterTreeView();
+    void StartBackgroundLoad(std::unique_ptr<LogLoader> loader);
+    void CancelLoad();
+    bool IsLoading() const;
     TreeModel* GetTreeModel();
     QTreeView* GetTreeView();
 
@@ -53,11 +61,18 @@ private:
     void RowFindImpl(int offset);
     void ShowDetails(const QModelIndex& idx, ValueDlg& valueDlg);
     void ReadFile();
-    void ReadDirectoryFiles();
-    void SetUpTimer();
-    void SetUpFile(std::shared_ptr<QFile> file);
+    void ReadDirectoryFiles(const QStringList& changedFiles, const QStringList& changedDirectories);
+    void DirectoryReadFinished();
+    void SetUpWatcher();
+    void OnFilesChanged(const QStringList& changedFiles, const QStringList& changedDirectories);
+    void SetUpFile(std::shared_ptr<QFile> file, bool fromStart);
+    void WatchDirectory(const QString& path, bool fromStart);
+    void ScanDirectory(const QString& path, bool fromStart);
+    void ForgetFile(const QString& path);
+    void ForgetDirectory(const QString& path);
     void UpdateModelView();
     void TrimEventCount();
+    bool SpansMultipleDays() const;
     bool StartFileLiveCapture();
     void StartDirectoryLiveCapture();
     QString GetDebugInfo() const;
@@ -86,11 +101,28 @@ private:
     int m_openFileMenuIdx;
     int m_eventIndex;
     QFile m_logFile;
-    QTimer m_timer;
+    quint64 m_logFileId = 0;
+    FileWatcher m_watcher;
     std::unique_ptr<QDir> m_liveDirectory;
     QHash<QString, std::shared_ptr<QFile>> m_directoryFiles;
-    QList<QString> m_excludedFileNames;
+    // Identities of the open files, to notice when a path leads to a new file, see FileSnapshot::FileId
+    QHash<QString, quint64> m_directoryFileIds;
+    QSet<QString> m_excludedFileNames;
+    // The files seen in each watched directory
+    QHash<QString, QSet<QString>> m_directoryEntries;
+    // Files that showed up since the last read, which are read from their start
+    QSet<QString> m_addedFiles;
+    QList<QRegularExpression> m_includeGlobs;
+    QList<QRegularExpression> m_excludeGlobs;
+    bool m_recursiveCapture = false;
+    // Reads the changed files of a directory capture, one task per file
+    QFutureWatcher<EventList> m_directoryRead;
+    QSet<QString> m_pendingChangedFiles;
+    QSet<QString> m_pendingChangedDirectories;
     QString m_tabPath;
+    std::unique_ptr<LogLoader> m_loader;
+    bool m_deferredLiveCapture = false;
+    qint64 m_liveStartOffset = -1;
 
 private slots:
     void RowDoubleClicked(const QModelIndex& idx);
@@ -111,6 +143,9 @@ private slots:
     void ExportToNewTab();
     void ExportToNewTab(COL column);
     void OpenSelectedFile();
+    void AddLoadedEvents(EventListPtr events);
+    void LoadProgressChanged(int percent);
+    void LoadFinished(int skippedCount, bool cancelled);
 
 signals:
     void menuUpdateNeeded();
@@ -1,14 +1,21 @@
 #include "mainwindow.h"
 
+#include "eventloader.h"
 #include "finddlg.h"
+#include "gzipreader.h"
 #include "highlightdlg.h"
+#include "logindex.h"
+#include "logsource.h"
 #include "logtab.h"
 #include "options.h"
 #include "optionsdlg.h"
 #include "pathhelper.h"
-#include "processevent.h"
 #include "savefilterdialog.h"
 #include "themeutils.h"
+#include "timerangedlg.h"
+#include "timeutils.h"
+#include "ziparchive.h"
+#include "zipmembersdlg.h"
 #include "zoomabletreeview.h"
 
 #include <map>
@@ -26,6 +33,7 @@
 #include <QJsonObject>
 #include <QLabel>
 #include <QLineEdit>
+#include <QLocale>
 #include <QMessageBox>
 #include <QMimeData>
 #include <QScrollBar>
@@ -58,6 +66,11 @@ MainWindow::MainWindow()
     menuHelp->addAction(aboutVersionAction);
 
     connect(Ui_MainWindow::menuRecent_files, SIGNAL(triggered(QAction*)), this, SLOT(Recent_files_triggered(QAction*)));
+    connect(m_statusBar->GetCancelButton(), &QAbstractButton::clicked, this, [this]() {
+        LogTab * logTab = GetCurrentLogTab();
+        if (logTab)
+            logTab->CancelLoad();
+    });
 
     tabWidget->tabBar()->installEventFilter(this);
 }
@@ -114,7 +127,7 @@ QString MainWindow::GetOpenDefaultFolder()
 
 QStringList MainWindow::PickLogFilesToOpen(QString caption)
 {
-    QFileDialog fileDlg(this, caption, GetOpenDefaultFolder(), "Log Files (*.txt *.log);;All Files (*)");
+    QFileDialog fileDlg(this, caption, GetOpenDefaultFolder(), "Log Files (*.txt *.log *.gz *.zip);;All Files (*)");
     fileDlg.setFileMode(QFileDialog::ExistingFiles);
     fileDlg.exec();
     m_lastOpenFolder = fileDlg.directory().absolutePath();
@@ -168,15 +181,16 @@ void MainWindow::UpdateMenuAndStatusBar()
     TreeModel * model = logTab ? logTab->GetTreeModel() : nullptr;
     bool hasFilters = model && model->HasHighlightFilters();
     bool hasFindOpts = model && model->ValidFindOpts();
+    bool isLoading = logTab && logTab->IsLoading();
 
     // Menu items
     menuHighlight->setEnabled(logTab);
     menuFind->setEnabled(logTab);
     // QActions
     // File
-    actionMerge_into_tab->setEnabled(logTab);
-    actionClear_all_events->setEnabled(logTab);
-    actionRefresh->setEnabled(logTab);
+    actionMerge_into_tab->setEnabled(logTab && !isLoading);
+    actionClear_all_events->setEnabled(logTab && !isLoading);
+    actionRefresh->setEnabled(logTab && !isLoading);
     actionShow_summary->setEnabled(logTab);
     actionCreate_info_viz->setEnabled(logTab);
     actionClose_tab->setEnabled(logTab);
@@ -201,6 +215,7 @@ void MainWindow::UpdateMenuAndStatusBar()
     // Status bar
     if (logTab == nullptr)
     {
+        m_statusBar->HideProgress();
         m_statusBar->SetRightLabelText("¯\\_(ツ)_/¯");
         return;
     }
@@ -257,38 +272,208 @@ void MainWindow::ReadSettings()
     ZoomableTreeView::ReadSettings(settings);
 }
 
-EventListPtr MainWindow::GetEventsFromFile(QString path, int & skippedCount)
+EventListPtr MainWindow::GetEventsFromFile(QString path, int & skippedCount, FileSnapshot* snapshot)
 {
     auto events = std::make_shared<EventList>();
-    QFile logfile(path);
-    QFileInfo logfileinfo(path);
-
-    int eventCount = 0;
+    QString archivePath;
+    QString memberName;
+    if (!QFileInfo(path).isFile() && ZipArchive::SplitMemberPath(path, archivePath, memberName))
+    {
+        // A log file inside of an archive, as added by LoadZipMembers
+        ZipArchive archive(archivePath);
+        if (snapshot)
+        {
+            *snapshot = FileSnapshot(memberName);
+        }
+        if (!archive.Open())
+        {
+            return events;
+        }
+        QStringList failedMembers;
+        events = EventLoader::ParseZipMembers(archive, {memberName}, m_options.GetParseSettings(), skippedCount, failedMembers).first();
+        if (!failedMembers.isEmpty())
+        {
+            QMessageBox::warning(this, tr("Unable to extract file"), tr("\"%1\" could not be extracted from \"%2\"").arg(memberName, archivePath));
+        }
+        return events;
+    }
 
-    if (logfile.open(QIODevice::ReadOnly))
+    if (GzipReader::IsGzipFile(path))
     {
-        while (!logfile.atEnd())
+        // Blocks are parsed while the reader inflates the next ones
+        GzipReader reader(path);
+        if (snapshot)
         {
-            auto line = logfile.readLine().trimmed();
-            if (line.isEmpty())
-            {
-                continue;
-            }
-            QJsonObject ev = ProcessEvent::ProcessLogEventMessage(++eventCount, line, logfileinfo.fileName());
-            if (!ev.isEmpty())
-            {
-                events->append(ev);
-            }
-            else
-            {
-                skippedCount++;
-            }
+            *snapshot = FileSnapshot(reader.FileName());
+        }
+        if (!reader.Start())
+        {
+            QMessageBox::warning(this, tr("Unable to open file"), tr("Unable to open file \"%1\"").arg(path));
+            return events;
+        }
+        const ParseSettings settings = m_options.GetParseSettings();
+        int index = 1;
+        QByteArray block;
+        while (reader.NextBlock(block))
+        {
+            index += EventLoader::ParseEvents(block, reader.FileName(), index, *events, skippedCount, settings);
         }
-        logfile.close();
+        if (reader.HasError())
+        {
+            QMessageBox::warning(this, tr("File partly loaded"),
+                                 tr("\"%1\" is damaged or truncated. Only the %2 events before the damage were loaded.")
+                                 .arg(reader.FileName(), QString::number(events->size())));
+        }
+        return events;
+    }
+
+    auto source = std::make_shared<LogSource>(path);
+    if (!source->Open())
+    {
+        return events;
+    }
+
+    // Only whole lines are read. A line that is still being written is read by the next refresh.
+    const qsizetype end = source->Data().lastIndexOf('\n') + 1;
+    const ParseSettings settings = m_options.GetParseSettings();
+    if (!LogIndex::Load(source, path, settings, *events, skippedCount))
+    {
+        EventLoader::ParseEvents(source->Data().first(end), source->FileName(), 1, *events, skippedCount, settings, source);
+    }
+    if (snapshot)
+    {
+        *snapshot = FileSnapshot(path, *source, end);
     }
     return events;
 }
 
+// Reads the lines that were appended to a file since its snapshot, and advances the snapshot.
+// Returns false if the file was replaced and has to be loaded again.
+bool MainWindow::GetAppendedEvents(const QString& path, FileSnapshot& snapshot, EventList& events, int& skippedCount)
+{
+    auto source = std::make_shared<LogSource>(path);
+    if (!source->Open())
+        return false;
+
+    switch (snapshot.Compare(path, *source))
+    {
+        case FileSnapshot::Change::None:
+            return true;
+        case FileSnapshot::Change::Replaced:
+            return false;
+        case FileSnapshot::Change::Appended:
+            break;
+    }
+
+    // Only whole lines are read. A line that is still being written is read by the next refresh.
+    QByteArrayView data = source->Data();
+    qsizetype end = data.lastIndexOf('\n') + 1;
+    if (end <= snapshot.Offset())
+        return true;
+
+    QByteArrayView tail = data.sliced(snapshot.Offset(), end - snapshot.Offset());
+    int lineCount = EventLoader::ParseEvents(tail, source->FileName(), snapshot.NextIndex(*source), events, skippedCount, m_options.GetParseSettings(), source);
+    snapshot.Advance(*source, end, lineCount);
+    return true;
+}
+
+// Returns false if the archive can't be read. Nothing is added if the user cancels or picks no member.
+bool MainWindow::LoadZipMembers(QString path, QList<EventListPtr>& memberEvents, QStringList& memberPaths, QList<FileSnapshot>& memberSnapshots, int& skippedCount)
+{
+    ZipArchive archive(path);
+    if (!archive.Open())
+    {
+        QMessageBox::warning(this, tr("Unable to open archive"), tr("Unable to read the zip archive \"%1\"").arg(path));
+        return false;
+    }
+
+    ZipMembersDlg membersDlg(this, archive);
+    if (membersDlg.exec() != QDialog::Accepted)
+        return true;
+
+    QStringList memberNames = membersDlg.GetCheckedMembers();
+    if (memberNames.isEmpty())
+        return true;
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    QStringList failedMembers;
+    memberEvents.append(EventLoader::ParseZipMembers(archive, memberNames, m_options.GetParseSettings(), skippedCount, failedMembers));
+    QApplication::restoreOverrideCursor();
+    if (!failedMembers.isEmpty())
+    {
+        QMessageBox::warning(this, tr("Unable to extract files"), tr("These files could not be extracted from \"%1\":\n%2")
+                             .arg(QFileInfo(path).fileName(), failedMembers.join("\n")));
+    }
+
+    // Members are refreshed through paths that point inside of the archive
+    for (const QString& memberName : memberNames)
+    {
+        memberPaths.append(path + "/" + memberName);
+        memberSnapshots.append(FileSnapshot(memberName));
+    }
+    return true;
+}
+
+// Loads only the events of a part of a file, for files too big to load whole.
+// The part is found by a binary search on the mapped file, without reading the rest of it.
+void MainWindow::LoadTimeRange(const QString& path)
+{
+    QFileInfo fi(path);
+    if (GzipReader::IsGzipFile(path) || ZipArchive::IsZipFile(path))
+    {
+        QMessageBox::warning(this, tr("Unable to open time range"),
+                             tr("\"%1\" is compressed, a time range can only be opened of a plain log file").arg(fi.fileName()));
+        return;
+    }
+
+    auto source = std::make_shared<LogSource>(path);
+    qint64 firstTime = TimeUtils::InvalidTime;
+    qint64 lastTime = TimeUtils::InvalidTime;
+    if (!source->Open())
+    {
+        QMessageBox::warning(this, tr("Unable to open file"), tr("Unable to open file \"%1\"").arg(path));
+        return;
+    }
+    if (!EventLoader::FindTimeBounds(source->Data(), firstTime, lastTime))
+    {
+        QMessageBox::warning(this, tr("Unable to open time range"), tr("\"%1\" has no timestamped events").arg(fi.fileName()));
+        return;
+    }
+
+    TimeRangeDlg rangeDlg(this, fi.fileName(), firstTime, lastTime);
+    if (rangeDlg.exec() != QDialog::Accepted)
+        return;
+    const qint64 startTime = rangeDlg.GetStartTime();
+    const qint64 endTime = rangeDlg.GetEndTime();
+
+    // Lines are numbered from the start of the range, numbering them from the start of the file
+    // would mean reading all of it
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    auto events = std::make_shared<EventList>();
+    int skippedCount = 0;
+    QByteArrayView range = EventLoader::FindTimeRange(source->Data(), startTime, endTime);
+    EventLoader::ParseEvents(range, source->FileName(), 1, *events, skippedCount, m_options.GetParseSettings(), source);
+    QApplication::restoreOverrideCursor();
+
+    // The tab holds a slice of the file, so it is neither refreshed nor tailed
+    LogTab * logTab = new LogTab(tabWidget, m_statusBar, events);
+    logTab->GetTreeModel()->SetTabType(TABTYPE::ExportedEvents);
+    actionTail_current_tab->setEnabled(false);
+    connect(logTab, &LogTab::menuUpdateNeeded, this, &MainWindow::UpdateMenuAndStatusBar);
+    connect(logTab, &LogTab::exportToTab, this, &MainWindow::ExportEventsToTab);
+    QString label = QString("%1 [%2 - %3]").arg(fi.fileName(),
+        TimeUtils::FormatTime(startTime, false), TimeUtils::FormatTime(endTime, false));
+    int idx = tabWidget->addTab(logTab, label);
+    tabWidget->setTabToolTip(idx, QString("%1\n%2 - %3").arg(path,
+        TimeUtils::FormatTime(startTime, true), TimeUtils::FormatTime(endTime, true)));
+    tabWidget->setCurrentIndex(idx);
+    logTab->setFocus();
+    UpdateMenuAndStatusBar();
+    statusBar()->showMessage(QString("%1 events loaded from %2 of %3; %4 events skipped").arg(
+        QString::number(events->size()), QLocale().formattedDataSize(range.size()),
+        QLocale().formattedDataSize(source->Data().size()), QString::number(skippedCount)), 3000);
+}
+
 void MainWindow::ExportEventsToTab(QModelIndexList list, QString name)
 {
     auto events = std::make_shared<EventList>();
@@ -298,8 +483,8 @@ void MainWindow::ExportEventsToTab(QModelIndexList list, QString name)
     {
         if (event.parent().row() == -1 || !list.contains(event.parent()))
         {
-            QJsonObject jsonData = model->GetEvent(event);
-            events->append(jsonData);
+            // The exported tab shares the records, values are only rehydrated when shown
+            events->append(model->GetLogEvent(event));
         }
     }
 
@@ -368,32 +553,58 @@ void MainWindow::RemoveRecentFile(const QString& path)
     }
 }
 
-void MainWindow::MergeLogFile(QString path)
+void MainWindow::MergeLogFiles(const QStringList& paths)
 {
-    EventListPtr events;
-    QString fileName;
-    QString filePath;
     int skippedCount = 0;
+    QList<EventListPtr> memberEvents;
+    QStringList memberPaths;
+    QList<FileSnapshot> memberSnapshots;
+    QStringList fileNames;
 
-    QFileInfo fi(path);
-    if (!fi.exists() || !fi.isFile())
+    for (const QString& path : paths)
     {
-        QMessageBox::warning(this, tr("Unable to open file"), tr("Unable to open file \"%1\"").arg(path));
-        return;
+        QFileInfo fi(path);
+        if (!fi.exists() || !fi.isFile())
+        {
+            QMessageBox::warning(this, tr("Unable to open file"), tr("Unable to open file \"%1\"").arg(path));
+            continue;
+        }
+
+        if (ZipArchive::IsZipFile(path))
+        {
+            if (!LoadZipMembers(path, memberEvents, memberPaths, memberSnapshots, skippedCount))
+                continue;
+        }
+        else
+        {
+            FileSnapshot snapshot;
+            memberEvents.append(GetEventsFromFile(path, skippedCount, &snapshot));
+            memberPaths.append(fi.filePath());
+            memberSnapshots.append(snapshot);
+        }
+        fileNames.append(fi.fileName());
     }
-    events = GetEventsFromFile(path, skippedCount);
 
-    fileName = fi.fileName();
-    filePath = fi.filePath();
+    if (fileNames.isEmpty())
+        return;
 
     // Set tab text
     int currIdx = tabWidget->currentIndex();
-    tabWidget->setTabText(currIdx, tabWidget->tabText(currIdx) + ", " + fileName);
+    tabWidget->setTabText(currIdx, tabWidget->tabText(currIdx) + ", " + fileNames.join(", "));
 
-    // Merge events in, add file name to model's paths
+    // Merge all the events in at once, add file names to model's paths
     TreeModel * model = GetCurrentTreeModel();
-    model->MergeIntoModelData(*events);
-    model->m_paths.append(filePath);
+    model->MergeIntoModelData(memberEvents);
+    if (model->m_liveMode)
+    {
+        // The files of a live tab may change under it
+        model->DetachFiles();
+    }
+    model->m_paths.append(memberPaths);
+    for (int i = 0; i < memberPaths.size(); i++)
+    {
+        model->m_fileSnapshots.insert(memberPaths[i], memberSnapshots[i]);
+    }
 
     // Update status
     LogTab * logTab = GetCurrentLogTab();
@@ -447,7 +658,10 @@ inline QString SystemCase(const QString& path)
 
 bool MainWindow::LoadLogFile(QString path)
 {
-    EventListPtr events;
+    // Number of lines parsed up front, before the tab is shown.
+    // The rest of the file is loaded in the background.
+    const int FirstScreenLineCount = 5000;
+
     QString fileName;
     QString filePath;
     int skippedCount = 0;
@@ -458,19 +672,99 @@ bool MainWindow::LoadLogFile(QString path)
         QMessageBox::warning(this, tr("Unable to open file"), tr("Unable to open file \"%1\"").arg(path));
         return false;
     }
-    events = GetEventsFromFile(path, skippedCount);
 
     fileName = fi.fileName();
     filePath = fi.filePath();
 	path.replace("\\", "/");
-    if (!m_allFiles.contains(SystemCase(filePath)))
+    if (m_allFiles.contains(SystemCase(filePath)))
     {
-        SetUpTab(events, false, path, fileName);
+        FocusOpenedFile(path);
+        return true;
     }
-    else
+
+    if (ZipArchive::IsZipFile(path))
     {
-        FocusOpenedFile(path);
+        QList<EventListPtr> memberEvents;
+        QStringList memberPaths;
+        QList<FileSnapshot> memberSnapshots;
+        if (!LoadZipMembers(path, memberEvents, memberPaths, memberSnapshots, skippedCount))
+            return false;
+        // Cancelled, the archive stays in the recent files
+        if (memberPaths.isEmpty())
+            return true;
+
+        // Merge the members before the tab is set up, so its rows are built once
+        QList<const EventList*> lists;
+        for (const EventListPtr& member : memberEvents)
+        {
+            lists.append(member.get());
+        }
+        auto events = std::make_shared<EventList>(EventLoader::MergeSorted(lists));
+        memberEvents.clear();
+
+        LogTab* logTab = SetUpTab(events, false, path, fileName);
+        TreeModel* model = logTab->GetTreeModel();
+        model->m_paths = memberPaths;
+        for (int i = 0; i < memberPaths.size(); i++)
+        {
+            model->m_fileSnapshots.insert(memberPaths[i], memberSnapshots[i]);
+        }
+        statusBar()->showMessage(QString("%1 events loaded from %2 files; %3 events skipped").arg(
+            QString::number(model->rowCount()), QString::number(memberPaths.size()), QString::number(skippedCount)), 3000);
+        return true;
+    }
+
+    auto events = std::make_shared<EventList>();
+    std::unique_ptr<LogLoader> loader;
+    const ParseSettings settings = m_options.GetParseSettings();
+    if (GzipReader::IsGzipFile(path))
+    {
+        // Compressed files are streamed in the background from the start
+        auto reader = std::make_shared<GzipReader>(path);
+        if (!reader->Start())
+        {
+            QMessageBox::warning(this, tr("Unable to open file"), tr("Unable to open file \"%1\"").arg(path));
+            return false;
+        }
+        loader = std::make_unique<LogLoader>(reader, settings);
+        LogTab* logTab = SetUpTab(events, false, path, fileName, std::move(loader));
+        logTab->GetTreeModel()->m_fileSnapshots.insert(path, FileSnapshot(reader->FileName()));
+        return true;
     }
+
+    auto source = std::make_shared<LogSource>(path);
+    if (source->Open())
+    {
+        // Only whole lines are loaded, the same as the loader does. A line that is still being
+        // written is read by the next refresh.
+        QByteArrayView data = source->Data();
+        data = data.first(data.lastIndexOf('\n') + 1);
+        FileSnapshot snapshot(path, *source, data.size());
+
+        // An unchanged file that was fully loaded before comes back from its index at once
+        if (LogIndex::Load(source, path, settings, *events, skippedCount))
+        {
+            LogTab* logTab = SetUpTab(events, false, path, fileName);
+            logTab->GetTreeModel()->m_fileSnapshots.insert(path, snapshot);
+            return true;
+        }
+
+        qsizetype firstScreenEnd = EventLoader::FindLinesEnd(data, FirstScreenLineCount);
+        int lineCount = EventLoader::ParseEvents(data.first(firstScreenEnd), fileName, 1, *events, skippedCount, settings, source);
+        if (firstScreenEnd < data.size())
+        {
+            loader = std::make_unique<LogLoader>(source, firstScreenEnd, lineCount + 1, skippedCount, settings);
+            if (LogIndex::IsWorthIndexing(data.size()))
+            {
+                loader->WriteIndex(path, *events);
+            }
+        }
+        LogTab* logTab = SetUpTab(events, false, path, fileName, std::move(loader));
+        logTab->GetTreeModel()->m_fileSnapshots.insert(path, snapshot);
+        return true;
+    }
+
+    SetUpTab(events, false, path, fileName, std::move(loader));
     return true;
 }
 
@@ -493,12 +787,16 @@ void MainWindow::StartDirectoryLiveCapture(QString directoryPath, QString label)
     }
 }
 
-LogTab* MainWindow::SetUpTab(EventListPtr events, bool isDirectory, QString path, QString label)
+LogTab* MainWindow::SetUpTab(EventListPtr events, bool isDirectory, QString path, QString label, std::unique_ptr<LogLoader> loader)
 {
     LogTab * logTab = new LogTab(tabWidget, m_statusBar, events);
     connect(logTab, &LogTab::menuUpdateNeeded, this, &MainWindow::UpdateMenuAndStatusBar);
     connect(logTab, &LogTab::exportToTab, this, &MainWindow::ExportEventsToTab);
     connect(logTab, &LogTab::openFile, this, &MainWindow::LoadLogFile);
+    if (loader)
+    {
+        logTab->StartBackgroundLoad(std::move(loader));
+    }
     int idx = tabWidget->addTab(logTab, label);
     m_allFiles.append(SystemCase(path));
 
@@ -521,7 +819,9 @@ LogTab* MainWindow::SetUpTab(EventListPtr events, bool isDirectory, QString path
     tabWidget->setCurrentIndex(idx);
     logTab->setFocus();
 
-    bool futureTabsUnderLive = m_options.getFutureTabsUnderLive();
+    // Compressed files can't be tailed
+    bool futureTabsUnderLive = m_options.getFutureTabsUnderLive() &&
+        !GzipReader::IsGzipFile(path) && !ZipArchive::IsZipFile(path);
     if (isDirectory || futureTabsUnderLive)
     {
         actionTail_current_tab->setChecked(true);
@@ -643,6 +943,13 @@ void MainWindow::on_actionOpen_in_new_tab_triggered()
         LoadLogFile(file);
 }
 
+void MainWindow::on_actionOpen_time_range_triggered()
+{
+    QStringList files = PickLogFilesToOpen("Select one or more log files to open a time range of");
+    for (const QString& file : files)
+        LoadTimeRange(file);
+}
+
 void MainWindow::on_actionOpen_log_txt_triggered()
 {
     if (!LoadLogFile(PathHelper::GetTableauLogFilePath(false)))
@@ -675,17 +982,17 @@ void MainWindow::on_actionMerge_into_tab_triggered()
 {
     QStringList files = PickLogFilesToOpen("Select one or more log files to merge into current tab");
     TreeModel * model = GetCurrentTreeModel();
-    bool merged = false;
+    QStringList newFiles;
     foreach(auto file, files)
     {
         if(!model->m_paths.contains(file))
         {
-            merged = true;
-            MergeLogFile(file);
+            newFiles.append(file);
         }
     }
-    if(merged)
+    if (!newFiles.isEmpty())
     {
+        MergeLogFiles(newFiles);
         QTreeView * treeView = GetCurrentTreeView();
         treeView->setColumnHidden(COL::File, false);
     }
@@ -702,11 +1009,71 @@ void MainWindow::on_actionRefresh_triggered()
     // TODO: Save the current line ID and go back to the line after refresh.
 
     int skipped = 0;
-    model->removeRows(0, model->rowCount());
-    for (QString path : model->m_paths)
+    QList<EventListPtr> eventLists;
+    QStringList reloadPaths;
+    QSet<QString> reloadFileNames;
+    QHash<QString, EventListPtr> appendedEvents;
+    for (const QString& path : model->m_paths)
+    {
+        if (!model->m_fileSnapshots.contains(path))
+        {
+            // Without knowing which rows came from where, everything is reloaded
+            reloadPaths = model->m_paths;
+            reloadFileNames.clear();
+            appendedEvents.clear();
+            model->removeRows(0, model->rowCount());
+            break;
+        }
+
+        // Files that only grew are read from where the last load stopped
+        FileSnapshot& snapshot = model->m_fileSnapshots[path];
+        auto events = std::make_shared<EventList>();
+        if (GetAppendedEvents(path, snapshot, *events, skipped))
+        {
+            appendedEvents.insert(path, events);
+        }
+        else
+        {
+            reloadPaths.append(path);
+            reloadFileNames.insert(snapshot.FileName());
+        }
+    }
+
+    if (!reloadFileNames.isEmpty())
+    {
+        // Rows are told apart by file name, so other files of the same name are reloaded as well
+        for (const QString& path : model->m_paths)
+        {
+            if (!reloadPaths.contains(path) && reloadFileNames.contains(model->m_fileSnapshots[path].FileName()))
+            {
+                reloadPaths.append(path);
+                appendedEvents.remove(path);
+            }
+        }
+        // Removing rows drops the snapshots, the ones of the files that are kept still hold
+        const QHash<QString, FileSnapshot> snapshots = model->m_fileSnapshots;
+        model->RemoveTopLevelRows(model->FindRows(COL::File, reloadFileNames));
+        model->m_fileSnapshots = snapshots;
+    }
+
+    for (const QString& path : model->m_paths)
+    {
+        if (reloadPaths.contains(path))
+        {
+            FileSnapshot snapshot;
+            eventLists.append(GetEventsFromFile(path, skipped, &snapshot));
+            model->m_fileSnapshots.insert(path, snapshot);
+        }
+        else if (appendedEvents.contains(path))
+        {
+            eventLists.append(appendedEvents[path]);
+        }
+    }
+    model->MergeIntoModelData(eventLists);
+    if (model->m_liveMode)
     {
-        EventListPtr events(GetEventsFromFile(path, skipped));
-        model->MergeIntoModelData(*events);
+        // The files of a live tab may change under it
+        model->DetachFiles();
     }
 
     if (model->m_highlightOnlyMode)
@@ -936,7 +1303,7 @@ void ShowSummary(TreeModel* model, QWidget* parent)
     for (int i = 0; i < model->rowCount(); i++)
     {
         QModelIndex valIndex = model->index(i, COL::Value);
-        QString keyString = model->GetEvent(valIndex)["k"].toString();
+        QString keyString = model->GetLogEvent(valIndex)["k"].toString();
         if (keyString == "begin-query")
         {
             break;
@@ -960,7 +1327,7 @@ void ShowSummary(TreeModel* model, QWidget* parent)
     {
         QModelIndex valIndex = model->index(i, COL::Value);
         QString valString = model->GetValueFullString(valIndex);
-        QJsonObject event = model->GetEvent(valIndex);
+        LogEvent event = model->GetLogEvent(valIndex);
         QString keyString = event["k"].toString();
         auto valObj = event["v"];
         for (SummaryCounter& counter : counters)
@@ -998,9 +1365,11 @@ void ShowSummary(TreeModel* model, QWidget* parent)
         auto lastIdx = model->index(model->rowCount() - 1, COL::Time);
         QString firstTimestamp = model->data(firstIdx, Qt::DisplayRole).toString();
         QString lastTimestamp = model->data(lastIdx, Qt::DisplayRole).toString();
-        auto firstDT = model->data(firstIdx, Qt::UserRole).toLongLong();
-        auto lastDT = model->data(lastIdx, Qt::UserRole).toLongLong();
-        auto diff = (lastDT - firstDT);
+        qint64 firstUSecs = model->TimeUSecs(firstIdx.row());
+        qint64 lastUSecs = model->TimeUSecs(lastIdx.row());
+        qint64 diff = 0;
+        if (firstUSecs != TimeUtils::InvalidTime && lastUSecs != TimeUtils::InvalidTime)
+            diff = (lastUSecs - firstUSecs) / 1000;
         summaryText += QString("Begin: %1\nEnd: %2\nSpan: %3\n\n")
                 .arg(firstTimestamp).arg(lastTimestamp).arg(msecsToString(diff));
     }
@@ -1185,7 +1554,7 @@ void GeQueryInfoViz(TreeModel* model)
     for (int i = 0; i < rowCount; i++)
     {
         QModelIndex valIndex = model->index(i, COL::Value);
-        QJsonObject event = model->GetEvent(valIndex);
+        LogEvent event = model->GetLogEvent(valIndex);
         QString keyString = event["k"].toString();
 
         auto elapsed = model->index(i, COL::Elapsed).data().toDouble();
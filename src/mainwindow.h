@@ -45,6 +45,7 @@ private slots:
     //Slots use underscores as per QT's automatic connection syntax
     //File
     void on_actionOpen_in_new_tab_triggered();
+    void on_actionOpen_time_range_triggered();
     void on_actionOpen_log_txt_triggered();
     void on_actionOpen_beta_log_txt_triggered();
     void on_actionMerge_into_tab_triggered();
@@ -84,7 +85,10 @@ private:
     void WriteSettings();
     void ReadSettings();
 
-    EventListPtr GetEventsFromFile(QString path, int & skippedCount);
+    EventListPtr GetEventsFromFile(QString path, int & skippedCount, FileSnapshot* snapshot = nullptr);
+    bool GetAppendedEvents(const QString& path, FileSnapshot& snapshot, EventList& events, int& skippedCount);
+    void LoadTimeRange(const QString& path);
+    bool LoadZipMembers(QString path, QList<EventListPtr>& memberEvents, QStringList& memberPaths, QList<FileSnapshot>& memberSnapshots, int& skippedCount);
 
     TreeModel * GetCurrentTreeModel();
     QTreeView * GetCurrentTreeView();
@@ -98,7 +102,7 @@ private:
     void AddRecentFile(const QString& path);
     void RemoveRecentFile(const QString& path);
 
-    void MergeLogFile(QString path);
+    void MergeLogFiles(const QStringList& paths);
     void FindPrev();
     void FindNext();
     void FindPrevH();
@@ -107,7 +111,7 @@ private:
 
     void StartDirectoryLiveCapture(QString directoryPath, QString label);
     void FocusOpenedFile(QString path);
-    LogTab* SetUpTab(EventListPtr events, bool isDirectory, QString path, QString label);
+    LogTab* SetUpTab(EventListPtr events, bool isDirectory, QString path, QString label, std::unique_ptr<LogLoader> loader = nullptr);
 
     Options& m_options = Options::GetInstance();
     StatusBar * m_statusBar;
@@ -0,0 +1,55 @@
+#include "memorybudget.h"
+
+#include "options.h"
+#include "treemodel.h"
+
+#include <algorithm>
+#include <QList>
+
+namespace
+{
+    const qint64 BytesPerMB = 1024 * 1024;
+
+    QList<TreeModel*> s_models;
+}
+
+namespace MemoryBudget
+{
+    void Register(TreeModel* model)
+    {
+        s_models.append(model);
+    }
+
+    void Unregister(TreeModel* model)
+    {
+        s_models.removeAll(model);
+    }
+
+    void Check()
+    {
+        const qint64 budget = Options::GetInstance().getMemoryBudget() * BytesPerMB;
+        if (budget <= 0)
+            return;
+
+        qint64 total = 0;
+        for (const TreeModel* model : s_models)
+        {
+            total += model->HeldValueBytes();
+        }
+        if (total <= budget)
+            return;
+
+        // Spill below the budget, so the next few events added don't spill again right away
+        const qint64 target = budget / 4 * 3;
+        QList<TreeModel*> models = s_models;
+        std::sort(models.begin(), models.end(), [](const TreeModel* a, const TreeModel* b) {
+            return a->HeldValueBytes() > b->HeldValueBytes();
+        });
+        for (TreeModel* model : models)
+        {
+            if (total <= target)
+                break;
+            total -= model->SpillColdValues(total - target);
+        }
+    }
+}
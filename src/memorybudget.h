@@ -0,0 +1,22 @@
+#ifndef MEMORYBUDGET_H
+#define MEMORYBUDGET_H
+
+class TreeModel;
+
+// Process-wide accounting of the event values that tabs hold in memory.
+// Values of events read from a mapped file live in the page cache and are not counted, nor is the
+// copy a live tab makes of such a file (see LogSource::Detach()), which is shared by all its
+// events. Values read from compressed files, archives and live capture are counted. Once the
+// total goes over the budget set in the options, the tabs holding the most are asked to spill the
+// values of their cold events to temporary files, until the total is back under three quarters
+// of the budget.
+// Only to be used from the GUI thread.
+namespace MemoryBudget
+{
+    void Register(TreeModel* model);
+    void Unregister(TreeModel* model);
+    // Called by a tab after it added events
+    void Check();
+}
+
+#endif // MEMORYBUDGET_H
@@ -2,12 +2,15 @@
 #include "pathhelper.h"
 
 #include <QByteArray>
+#include <QByteArrayList>
 #include <QDir>
 #include <QFile>
 #include <QJsonDocument>
 #include <QSettings>
 #include <QSysInfo>
 
+#include <algorithm>
+
 
 void Options::ReadSettings()
 {
@@ -18,6 +21,7 @@ void Options::ReadSettings()
     QStringList defaultSkip = {"dll-version-info", "ds-interpret-metadata"};
     m_skippedText = settings.value("skippedText", defaultSkip).toStringList();
     m_skippedState = settings.value("skippedState", QBitArray(m_skippedText.length(), true)).toBitArray();
+    UpdateSkippedKeys();
     m_visualizationServiceEnable = settings.value("visualizationServiceEnable", false).toBool();
     m_visualizationServiceURL = settings.value("visualizationServiceURL", QString("")).toString();
     auto defaultDiffToolPath = QSysInfo::productType() == "windows" ? QString("C:/Program Files (x86)/Beyond Compare 4/BCompare.exe") : QString("/usr/local/bin/bcomp");
@@ -25,8 +29,16 @@ void Options::ReadSettings()
     m_futureTabsUnderLive = settings.value("enableLiveCapture").toBool();
     m_defaultFilterName = settings.value("defaultHighlightFilter", "None").toString();
     m_captureAllTextFiles = settings.value("liveCaptureAllTextFiles", true).toBool();
+    m_liveCaptureRecursive = settings.value("liveCaptureRecursive", false).toBool();
+    m_liveCaptureIncludeGlobs = settings.value("liveCaptureIncludeGlobs", QStringList({"*.txt", "*.log"})).toStringList();
+    m_liveCaptureExcludeGlobs = settings.value("liveCaptureExcludeGlobs", QStringList()).toStringList();
     m_showArtDataInValue = settings.value("showArtDataInValue", false).toBool();
     m_showErrorCodeInValue = settings.value("showErrorCodeInValue", false).toBool();
+    m_deferValueParsing = settings.value("deferValueParsing", true).toBool();
+    m_indexLargeFiles = settings.value("indexLargeFiles", true).toBool();
+    m_memoryBudget = settings.value("memoryBudget", 2048).toInt();
+    m_liveEventLimit = settings.value("liveEventLimit", 100000).toInt();
+    m_liveMemoryLimit = settings.value("liveMemoryLimit", 0).toInt();
     m_syntaxHighlightLimit = settings.value("syntaxHighlightLimit", 15000).toInt();
     m_theme = settings.value("theme", "Native").toString();
     m_notation = settings.value("notation", "YAML").toString();
@@ -56,8 +68,16 @@ void Options::WriteSettings()
     settings.setValue("diffToolPath", m_diffToolPath);
     settings.setValue("enableLiveCapture", m_futureTabsUnderLive);
     settings.setValue("liveCaptureAllTextFiles", m_captureAllTextFiles);
+    settings.setValue("liveCaptureRecursive", m_liveCaptureRecursive);
+    settings.setValue("liveCaptureIncludeGlobs", m_liveCaptureIncludeGlobs);
+    settings.setValue("liveCaptureExcludeGlobs", m_liveCaptureExcludeGlobs);
     settings.setValue("showArtDataInValue", m_showArtDataInValue);
     settings.setValue("showErrorCodeInValue", m_showErrorCodeInValue);
+    settings.setValue("deferValueParsing", m_deferValueParsing);
+    settings.setValue("indexLargeFiles", m_indexLargeFiles);
+    settings.setValue("memoryBudget", m_memoryBudget);
+    settings.setValue("liveEventLimit", m_liveEventLimit);
+    settings.setValue("liveMemoryLimit", m_liveMemoryLimit);
     settings.setValue("defaultHighlightFilter", m_defaultFilterName);
     settings.setValue("syntaxHighlightLimit", m_syntaxHighlightLimit);
     settings.setValue("theme", m_theme);
@@ -73,6 +93,7 @@ QStringList Options::getSkippedText() const
 void Options::setSkippedText(const QStringList &skippedText)
 {
     m_skippedText = skippedText;
+    UpdateSkippedKeys();
 }
 
 QBitArray Options::getSkippedState() const
@@ -83,6 +104,44 @@ QBitArray Options::getSkippedState() const
 void Options::setSkippedState(const QBitArray &skippedState)
 {
     m_skippedState = skippedState;
+    UpdateSkippedKeys();
+}
+
+void Options::UpdateSkippedKeys()
+{
+    m_skippedKeys.clear();
+    for (int i = 0; i < m_skippedText.length() && i < m_skippedState.size(); i++)
+    {
+        if (m_skippedState[i])
+            m_skippedKeys.insert(m_skippedText[i].toUtf8());
+    }
+}
+
+ParseSettings Options::GetParseSettings() const
+{
+    // The key set is implicitly shared, UpdateSkippedKeys() detaches from the copy
+    ParseSettings settings;
+    settings.skippedKeys = m_skippedKeys;
+    settings.deferValueParsing = m_deferValueParsing;
+    return settings;
+}
+
+bool ParseSettings::HasSkippedKeys() const
+{
+    return !skippedKeys.isEmpty();
+}
+
+bool ParseSettings::IsSkippedKey(QByteArrayView key) const
+{
+    // fromRawData() avoids copying the key just to look it up
+    return skippedKeys.contains(QByteArray::fromRawData(key.data(), key.size()));
+}
+
+QByteArray ParseSettings::SkippedKeysSignature() const
+{
+    QList<QByteArray> keys = skippedKeys.values();
+    std::sort(keys.begin(), keys.end());
+    return keys.join('\n');
 }
 
 bool Options::getVisualizationServiceEnable() const
@@ -145,6 +204,56 @@ void Options::setShowErrorCodeInValue(const bool showErrorCodeInValue)
     m_showErrorCodeInValue = showErrorCodeInValue;
 }
 
+bool Options::getDeferValueParsing() const
+{
+    return m_deferValueParsing;
+}
+
+void Options::setDeferValueParsing(const bool deferValueParsing)
+{
+    m_deferValueParsing = deferValueParsing;
+}
+
+bool Options::getIndexLargeFiles() const
+{
+    return m_indexLargeFiles;
+}
+
+void Options::setIndexLargeFiles(const bool indexLargeFiles)
+{
+    m_indexLargeFiles = indexLargeFiles;
+}
+
+int Options::getMemoryBudget() const
+{
+    return m_memoryBudget;
+}
+
+void Options::setMemoryBudget(const int memoryBudget)
+{
+    m_memoryBudget = memoryBudget;
+}
+
+int Options::getLiveEventLimit() const
+{
+    return m_liveEventLimit;
+}
+
+void Options::setLiveEventLimit(const int liveEventLimit)
+{
+    m_liveEventLimit = liveEventLimit;
+}
+
+int Options::getLiveMemoryLimit() const
+{
+    return m_liveMemoryLimit;
+}
+
+void Options::setLiveMemoryLimit(const int liveMemoryLimit)
+{
+    m_liveMemoryLimit = liveMemoryLimit;
+}
+
 bool Options::getCaptureAllTextFiles() const
 {
     return m_captureAllTextFiles;
@@ -155,6 +264,36 @@ void Options::setCaptureAllTextFiles(const bool captureAllTextFiles)
     m_captureAllTextFiles = captureAllTextFiles;
 }
 
+bool Options::getLiveCaptureRecursive() const
+{
+    return m_liveCaptureRecursive;
+}
+
+void Options::setLiveCaptureRecursive(const bool liveCaptureRecursive)
+{
+    m_liveCaptureRecursive = liveCaptureRecursive;
+}
+
+QStringList Options::getLiveCaptureIncludeGlobs() const
+{
+    return m_liveCaptureIncludeGlobs;
+}
+
+void Options::setLiveCaptureIncludeGlobs(const QStringList& liveCaptureIncludeGlobs)
+{
+    m_liveCaptureIncludeGlobs = liveCaptureIncludeGlobs;
+}
+
+QStringList Options::getLiveCaptureExcludeGlobs() const
+{
+    return m_liveCaptureExcludeGlobs;
+}
+
+void Options::setLiveCaptureExcludeGlobs(const QStringList& liveCaptureExcludeGlobs)
+{
+    m_liveCaptureExcludeGlobs = liveCaptureExcludeGlobs;
+}
+
 QString Options::getDefaultFilterName() const
 {
     return m_defaultFilterName;
@@ -3,6 +3,24 @@
 #include "highlightoptions.h"
 
 #include <QBitArray>
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QSet>
+
+// The options that decide how log lines are parsed, copied from Options before a load starts.
+// Lines are parsed on other threads, which must not read Options while the options dialog
+// changes it.
+struct ParseSettings
+{
+    // UTF-8 keys of the skipped events
+    QSet<QByteArray> skippedKeys;
+    bool deferValueParsing = true;
+
+    bool HasSkippedKeys() const;
+    bool IsSkippedKey(QByteArrayView key) const;
+    // The skipped keys in a stable form, to tell whether events loaded earlier are still valid
+    QByteArray SkippedKeysSignature() const;
+};
 
 class Options
 {
@@ -10,16 +28,27 @@ private:
     Options(){ ReadSettings(); }
     Options(const Options&) = delete;
     Options& operator= (const Options&) = delete;
+    void UpdateSkippedKeys();
 
     QStringList m_skippedText;
     QBitArray m_skippedState;
+    // UTF-8 keys of the checked entries of m_skippedText, for lookups while loading
+    QSet<QByteArray> m_skippedKeys;
     bool m_visualizationServiceEnable;
     QString m_visualizationServiceURL;
     QString m_diffToolPath;
     bool m_futureTabsUnderLive;
     bool m_captureAllTextFiles;
+    bool m_liveCaptureRecursive;
+    QStringList m_liveCaptureIncludeGlobs;
+    QStringList m_liveCaptureExcludeGlobs;
     bool m_showArtDataInValue;
     bool m_showErrorCodeInValue;
+    bool m_deferValueParsing;
+    bool m_indexLargeFiles;
+    int m_memoryBudget;
+    int m_liveEventLimit;
+    int m_liveMemoryLimit;
     QString m_defaultFilterName;
     HighlightOptions m_defaultHighlightOpts;
     int m_syntaxHighlightLimit;
@@ -42,6 +71,9 @@ public:
     QBitArray getSkippedState() const;
     void setSkippedState(const QBitArray& skippedState);
 
+    // Call on the GUI thread, and hand the copy to the threads that parse
+    ParseSettings GetParseSettings() const;
+
     bool getVisualizationServiceEnable() const;
     void setVisualizationServiceEnable(const bool visualizationServiceEnable);
 
@@ -57,12 +89,37 @@ public:
     bool getCaptureAllTextFiles() const;
     void setCaptureAllTextFiles(const bool captureAllTextFiles);
 
+    // Which files of a directory live capture are followed. Globs without a slash match file names.
+    bool getLiveCaptureRecursive() const;
+    void setLiveCaptureRecursive(const bool liveCaptureRecursive);
+    QStringList getLiveCaptureIncludeGlobs() const;
+    void setLiveCaptureIncludeGlobs(const QStringList& liveCaptureIncludeGlobs);
+    QStringList getLiveCaptureExcludeGlobs() const;
+    void setLiveCaptureExcludeGlobs(const QStringList& liveCaptureExcludeGlobs);
+
     bool getShowArtDataInValue() const;
     void setShowArtDataInValue(const bool showArtDataInValue);
 
     bool getShowErrorCodeInValue() const;
     void setShowErrorCodeInValue(const bool showErrorCodeInValue);
 
+    bool getDeferValueParsing() const;
+    void setDeferValueParsing(const bool deferValueParsing);
+
+    bool getIndexLargeFiles() const;
+    void setIndexLargeFiles(const bool indexLargeFiles);
+
+    // In MB, 0 for no limit. See MemoryBudget.
+    int getMemoryBudget() const;
+    void setMemoryBudget(const int memoryBudget);
+
+    // The oldest events of a live capture are dropped beyond these, 0 for no limit
+    int getLiveEventLimit() const;
+    void setLiveEventLimit(const int liveEventLimit);
+    // In MB
+    int getLiveMemoryLimit() const;
+    void setLiveMemoryLimit(const int liveMemoryLimit);
+
     QString getDefaultFilterName() const;
     void setDefaultFilterName(const QString& defaultFilterName);
 
@@ -12,6 +12,20 @@
 #include <QInputDialog>
 #include <QPalette>
 
+namespace
+{
+    QStringList SplitGlobs(const QString& text)
+    {
+        QStringList globs;
+        for (const QString& glob : text.split(';', Qt::SkipEmptyParts))
+        {
+            if (!glob.trimmed().isEmpty())
+                globs.append(glob.trimmed());
+        }
+        return globs;
+    }
+}
+
 OptionsDlg::OptionsDlg(QWidget *parent) :
     QDialog(parent),
     ui(new Ui::OptionsDlg)
@@ -46,10 +60,18 @@ void OptionsDlg::WriteSettings()
     options.setDiffToolPath(ui->diffToolPath->text());
     options.setFutureTabsUnderLive(ui->startFutureLiveCapture->isChecked());
     options.setCaptureAllTextFiles(ui->captureAllTextFiles->isChecked());
+    options.setLiveCaptureRecursive(ui->captureSubdirectories->isChecked());
+    options.setLiveCaptureIncludeGlobs(SplitGlobs(ui->captureIncludeEdit->text()));
+    options.setLiveCaptureExcludeGlobs(SplitGlobs(ui->captureExcludeEdit->text()));
     options.setShowArtDataInValue(ui->showArtDataInValue->isChecked());
     options.setShowErrorCodeInValue(ui->showErrorCodeInValue->isChecked());
+    options.setDeferValueParsing(ui->deferValueParsing->isChecked());
+    options.setIndexLargeFiles(ui->indexLargeFiles->isChecked());
     options.setDefaultFilterName(ui->defaultHighlightComboBox->currentText());
     options.setSyntaxHighlightLimit(ui->syntaxHighlightLimitSpinBox->value());
+    options.setMemoryBudget(ui->memoryBudgetSpinBox->value());
+    options.setLiveEventLimit(ui->liveEventLimitSpinBox->value());
+    options.setLiveMemoryLimit(ui->liveMemoryLimitSpinBox->value());
     options.setTheme(ui->themeComboBox->currentText());
     options.setNotation(ui->notationComboBox->currentText());
 
@@ -79,9 +101,17 @@ void OptionsDlg::ReadSettings()
     ui->diffToolPath->setText(options.getDiffToolPath());
     ui->startFutureLiveCapture->setChecked(options.getFutureTabsUnderLive());
     ui->captureAllTextFiles->setChecked(options.getCaptureAllTextFiles());
+    ui->captureSubdirectories->setChecked(options.getLiveCaptureRecursive());
+    ui->captureIncludeEdit->setText(options.getLiveCaptureIncludeGlobs().join("; "));
+    ui->captureExcludeEdit->setText(options.getLiveCaptureExcludeGlobs().join("; "));
     ui->showArtDataInValue->setChecked(options.getShowArtDataInValue());
     ui->showErrorCodeInValue->setChecked(options.getShowErrorCodeInValue());
+    ui->deferValueParsing->setChecked(options.getDeferValueParsing());
+    ui->indexLargeFiles->setChecked(options.getIndexLargeFiles());
     ui->syntaxHighlightLimitSpinBox->setValue(options.getSyntaxHighlightLimit());
+    ui->memoryBudgetSpinBox->setValue(options.getMemoryBudget());
+    ui->liveEventLimitSpinBox->setValue(options.getLiveEventLimit());
+    ui->liveMemoryLimitSpinBox->setValue(options.getLiveMemoryLimit());
 
     const auto& themeNames = ThemeUtils::GetThemeNames();
     ui->themeComboBox->addItems(themeNames);
@@ -15,6 +15,11 @@ namespace PathHelper
         return GetConfigPath() + "/" + QStringLiteral("filters");
     }
 
+    QString GetIndexCachePath()
+    {
+        return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/" + QStringLiteral("index");
+    }
+
     QString GetConfigIniPath()
     {
         return GetConfigPath() + "/" + QStringLiteral("tlv.ini");
@@ -8,6 +8,7 @@ namespace PathHelper
     QString GetConfigPath();
     QString GetConfigIniPath();
     QString GetFiltersConfigPath();
+    QString GetIndexCachePath();
     QString GetDocumentsPath();
     QString GetTableauRepositoryPath(bool isBeta = false);
     QString GetTableauLogFolderPath(bool isBeta = false);
@@ -1,41 +1,72 @@
 #include "processevent.h"
 
-#include "options.h"
+#include "eventparser.h"
 #include "pathhelper.h"
 
-#include <QBitArray>
 #include <QJsonDocument>
 #include <QSettings>
 
 namespace ProcessEvent
 {
-    QJsonObject ProcessLogEventMessage(int index, QString message, const QString& fileName)
+    LogEvent ProcessLogEventMessage(int index, QByteArrayView line, const QString& fileName, const ParseSettings& settings, const LogSourcePtr& source)
     {
-        Options& options = Options::GetInstance();
-        QStringList m_SkippedText = options.getSkippedText();
-        QBitArray m_SkippedState = options.getSkippedState();
-
-        if (!message.startsWith("{"))
+        if (!line.startsWith('{'))
         {
             QJsonObject obj;
             obj["idx"] = index;
             obj["file"] = fileName;
             obj["k"] = "";
-            obj["v"] = message;
+            obj["v"] = QString::fromUtf8(line);
             return obj;
         }
         else
         {
-            message.insert(1, QString("\"file\": \"%1\",").arg(fileName));
-            message.insert(1, QString("\"idx\": %1,").arg(index));
-            QJsonDocument jsonDoc = QJsonDocument::fromJson(message.toUtf8());
-            if (jsonDoc.object().contains("k")
-                    && m_SkippedText.contains(jsonDoc.object()["k"].toString())
-                    && m_SkippedState[m_SkippedText.indexOf(jsonDoc.object()["k"].toString(), 0)])
+            // Drop skipped events before paying for the JSON parse
+            QByteArrayView key;
+            bool keyChecked = false;
+            if (settings.HasSkippedKeys() && EventParser::FindEventKey(line, key))
+            {
+                if (settings.IsSkippedKey(key))
+                {
+                    return LogEvent();
+                }
+                keyChecked = true;
+            }
+
+            QJsonObject obj;
+            QByteArrayView rawValue;
+            if (!EventParser::ParseObject(line, obj, settings.deferValueParsing ? &rawValue : nullptr))
+            {
+                // Parse the UTF-8 bytes in place. fromRawData() wraps the line without copying it.
+                QJsonParseError parseError;
+                QJsonDocument jsonDoc = QJsonDocument::fromJson(QByteArray::fromRawData(line.data(), line.size()), &parseError);
+                if (parseError.error != QJsonParseError::NoError || !jsonDoc.isObject())
+                {
+                    return QJsonObject();
+                }
+                obj = jsonDoc.object();
+                rawValue = QByteArrayView();
+            }
+
+            if (!keyChecked && settings.HasSkippedKeys() && obj.contains("k")
+                    && settings.IsSkippedKey(obj["k"].toString().toUtf8()))
+            {
+                return QJsonObject();
+            }
+
+            // idx and file are not part of the logged event, attach them to the parsed object
+            obj.insert("idx", index);
+            obj.insert("file", fileName);
+            if (!rawValue.isEmpty())
             {
-                jsonDoc = QJsonDocument();
+                // "v" stays unparsed until it is displayed, searched or expanded
+                if (source)
+                {
+                    return LogEvent(obj, source, rawValue);
+                }
+                return LogEvent(obj, rawValue);
             }
-            return jsonDoc.object();
+            return obj;
         }
     }
 }
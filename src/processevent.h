@@ -1,12 +1,17 @@
 #ifndef PROCESSEVENT_H
 #define PROCESSEVENT_H
 
-#include <QJsonObject>
+#include "logevent.h"
+#include "options.h"
+
+#include <QByteArrayView>
 #include <QString>
 
 namespace ProcessEvent
 {
-    QJsonObject ProcessLogEventMessage(int index, QString message, const QString& fileName);
+    // If line is a view into the data of source, unparsed values are read back from source
+    // rather than copied into the event.
+    LogEvent ProcessLogEventMessage(int index, QByteArrayView line, const QString& fileName, const ParseSettings& settings, const LogSourcePtr& source = nullptr);
 }
 
 #endif // PROCESSEVENT_H
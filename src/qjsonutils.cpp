@@ -11,7 +11,15 @@
 
 namespace
 {
-    void GetFlatNotation(const QString& key, const QJsonValue& value, QVector<QString>& stringList);
+    // Output budget of the current Format call. Negative means no limit.
+    thread_local int budget = -1;
+
+    bool OverBudget(qsizetype length)
+    {
+        return budget >= 0 && length >= budget;
+    }
+
+    void GetFlatNotation(const QString& key, const QJsonValue& value, QVector<QString>& stringList, qsizetype& length);
     const QString KeyValueString(const QString& key, const QString& value);
 
     void GetJson(const QJsonValue& value, QString& string, unsigned int level = 0);
@@ -23,61 +31,77 @@ namespace
     bool GetYamlTrivial(const QJsonValue& value, QString& string);
 }
 
-QString QJsonUtils::Format(const QJsonValue& jsonValue, Notation format, LineFormat lineFormat)
+namespace
 {
-    bool isSingleLine = (lineFormat == LineFormat::SingleLine);
-
-    if (jsonValue.isString())
+    QString FormatValue(const QJsonValue& jsonValue, QJsonUtils::Notation format, QJsonUtils::LineFormat lineFormat)
     {
-        QString result = jsonValue.toString().trimmed();
-        if (isSingleLine)
-            result = result.replace("\n", " ");
-        return result;
-    }
-    else if (!IsStructured(jsonValue))
-    {
-        QString result;
-        GetJsonLiteral(jsonValue, result);
-        return result;
-    }
-    else if (format == Notation::Flat)
-    {
-        QVector<QString> stringList;
-        GetFlatNotation("", jsonValue, stringList);
-        if (stringList.size() == 0)
-            return "";
-        QString lineBreak = isSingleLine ? "; " : "\n";
-        QString result;
-        for (const QString& str : stringList)
+        using namespace QJsonUtils;
+        bool isSingleLine = (lineFormat == LineFormat::SingleLine);
+
+        if (jsonValue.isString())
         {
-            result = result % lineBreak % str;
+            QString str = jsonValue.toString();
+            QString result = QStringView(str).trimmed().left(budget >= 0 ? budget : str.size()).toString();
+            if (isSingleLine)
+                result = result.replace("\n", " ");
+            return result;
         }
-        result = result.remove(0, lineBreak.size());
-        if (isSingleLine)
-            result = result.replace("\n", " ");
-        return result;
-    }
-    else {
-        QString builder;
-        switch (format)
+        else if (!IsStructured(jsonValue))
+        {
+            QString result;
+            GetJsonLiteral(jsonValue, result);
+            return result;
+        }
+        else if (format == Notation::Flat)
         {
-        case Notation::JSON:
-            isSingleLine ?
-                GetJsonSingleLine(jsonValue, builder) :
-                GetJson(jsonValue, builder);
-            break;
-        case Notation::YAML:
-            isSingleLine ?
-                GetYamlSingleLine(jsonValue, builder) :
-                GetYaml(jsonValue, builder);
-            break;
-        default:
-            return "NOT IMPLEMENTED";
-        }
-        return builder;
+            QVector<QString> stringList;
+            qsizetype length = 0;
+            GetFlatNotation("", jsonValue, stringList, length);
+            if (stringList.size() == 0)
+                return "";
+            QString lineBreak = isSingleLine ? "; " : "\n";
+            QString result;
+            for (const QString& str : stringList)
+            {
+                result = result % lineBreak % str;
+            }
+            result = result.remove(0, lineBreak.size());
+            if (isSingleLine)
+                result = result.replace("\n", " ");
+            return result;
+        }
+        else {
+            QString builder;
+            switch (format)
+            {
+            case Notation::JSON:
+                isSingleLine ?
+                    GetJsonSingleLine(jsonValue, builder) :
+                    GetJson(jsonValue, builder);
+                break;
+            case Notation::YAML:
+                isSingleLine ?
+                    GetYamlSingleLine(jsonValue, builder) :
+                    GetYaml(jsonValue, builder);
+                break;
+            default:
+                return "NOT IMPLEMENTED";
+            }
+            return builder;
+        }
     }
 }
 
+QString QJsonUtils::Format(const QJsonValue& jsonValue, Notation format, LineFormat lineFormat, int maxLength)
+{
+    budget = maxLength;
+    QString result = FormatValue(jsonValue, format, lineFormat);
+    budget = -1;
+    if (maxLength >= 0)
+        result.truncate(maxLength);
+    return result;
+}
+
 static QMap<QString, QJsonUtils::Notation> notationNamesMap = {
     {"Flat", QJsonUtils::Notation::Flat},
     {"JSON", QJsonUtils::Notation::JSON},
@@ -114,8 +138,12 @@ QString QJsonUtils::GetNameForNotation(Notation notation)
 
 namespace
 {
-    void GetFlatNotation(const QString& key, const QJsonValue& value, QVector<QString>& stringList)
+    void GetFlatNotation(const QString& key, const QJsonValue& value, QVector<QString>& stringList, qsizetype& length)
     {
+        if (OverBudget(length))
+            return;
+
+        const qsizetype count = stringList.size();
         if (value.isDouble())
         {
             // There are no ints in JSON, only doubles
@@ -127,9 +155,9 @@ namespace
         else if (value.isObject())
         {
             QJsonObject childObj = value.toObject();
-            for (QJsonObject::ConstIterator iter = childObj.constBegin(); iter != childObj.constEnd(); ++iter)
+            for (QJsonObject::ConstIterator iter = childObj.constBegin(); iter != childObj.constEnd() && !OverBudget(length); ++iter)
             {
-                GetFlatNotation(iter.key(), iter.value(), stringList);
+                GetFlatNotation(iter.key(), iter.value(), stringList, length);
             }
         }
         else if (value.isArray())
@@ -137,10 +165,13 @@ namespace
             QJsonArray array = value.toArray();
             int itemIndex = 1;
             stringList.append(KeyValueString(key, ""));
+            length += stringList.last().size();
             for (const QJsonValue& itemValue : array)
             {
+                if (OverBudget(length))
+                    break;
                 auto itemKey = QString("%1-%2").arg(key).arg(itemIndex++);
-                GetFlatNotation(itemKey, itemValue, stringList);
+                GetFlatNotation(itemKey, itemValue, stringList, length);
             }
         }
         else if (value.isBool())
@@ -159,6 +190,10 @@ namespace
         {
             stringList.append(KeyValueString(key, value.toString()));
         }
+
+        // Separators are not counted, so the length only reaches the budget when the output does
+        if (!value.isObject() && !value.isArray() && stringList.size() > count)
+            length += stringList.last().size();
     }
 
     const QString KeyValueString(const QString& key, const QString& value)
@@ -181,6 +216,8 @@ namespace
             int pendingKeys = obj.length();
             for (QJsonObject::ConstIterator iter = obj.constBegin(); iter != obj.constEnd(); ++iter)
             {
+                if (OverBudget(string.size()))
+                    return;
                 string.append(indentation);
                 string.append("  \"");
                 string.append(iter.key());
@@ -200,6 +237,8 @@ namespace
             int pendingElements = value.toArray().count();
             for (const QJsonValue& itemValue : value.toArray())
             {
+                if (OverBudget(string.size()))
+                    return;
                 string.append(indentation);
                 string.append("  ");
                 GetJson(itemValue, string, level + 1);
@@ -225,6 +264,8 @@ namespace
             int pendingKeys = obj.length();
             for (QJsonObject::ConstIterator iter = obj.constBegin(); iter != obj.constEnd(); ++iter)
             {
+                if (OverBudget(string.size()))
+                    return;
                 string.append("\"");
                 string.append(iter.key());
                 string.append("\": ");
@@ -241,6 +282,8 @@ namespace
             int pendingElements = value.toArray().count();
             for (const QJsonValue& itemValue : value.toArray())
             {
+                if (OverBudget(string.size()))
+                    return;
                 GetJsonSingleLine(itemValue, string);
                 if (pendingElements > 1)
                     string.append(", ");
@@ -277,7 +320,11 @@ namespace
         else if (value.isString())
         {
             string.append("\"");
-            string.append(value.toString().replace('\n', "\\n").replace('"', "\\\""));
+            QString str = value.toString();
+            // Escaping never shortens the string, so the start of it is enough to fill the budget
+            if (budget >= 0)
+                str.truncate(qMax<qsizetype>(0, budget - string.size()));
+            string.append(str.replace('\n', "\\n").replace('"', "\\\""));
             string.append("\"");
         }
         else
@@ -304,6 +351,8 @@ namespace
             int pendingKeys = obj.length();
             for (QJsonObject::ConstIterator iter = obj.constBegin(); iter != obj.constEnd(); ++iter)
             {
+                if (OverBudget(string.size()))
+                    return;
                 string.append(indentation);
                 string.append(iter.key());
                 string.append(": ");
@@ -325,6 +374,8 @@ namespace
                 string.append("\n");
                 for (const QJsonValue& itemValue : value.toArray())
                 {
+                    if (OverBudget(string.size()))
+                        return;
                     string.append(indentation);
                     string.append("- ");
                     GetYaml(itemValue, string, level + 1);
@@ -365,6 +416,8 @@ namespace
             int pendingKeys = obj.length();
             for (QJsonObject::ConstIterator iter = obj.constBegin(); iter != obj.constEnd(); ++iter)
             {
+                if (OverBudget(string.size()))
+                    return;
                 string.append(iter.key());
                 string.append(": ");
                 GetYamlSingleLine(iter.value(), string);
@@ -381,6 +434,8 @@ namespace
             string.append("[ ");
             for (const QJsonValue& itemValue : value.toArray())
             {
+                if (OverBudget(string.size()))
+                    return;
                 GetYamlSingleLine(itemValue, string);
                 if (pendingElements > 1)
                     string.append(", ");
@@ -20,7 +20,10 @@ namespace QJsonUtils
         Free
     };
 
-    QString Format(const QJsonValue& value, Notation format, LineFormat lineFormat = LineFormat::Free);
+    // maxLength, if not negative, is a budget for the output: formatting stops once it is reached
+    // and the result is cut to maxLength characters. The result is then the same as the start of
+    // the full string, without walking all of a large value.
+    QString Format(const QJsonValue& value, Notation format, LineFormat lineFormat = LineFormat::Free, int maxLength = -1);
 
     QStringList GetNotationNames();
 
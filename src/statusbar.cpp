@@ -2,9 +2,21 @@
 
 StatusBar::StatusBar(QMainWindow* parent) :
     m_qbar(parent->statusBar()),
-    m_statusLabel(new QLabel(parent))
+    m_statusLabel(new QLabel(parent)),
+    m_progressBar(new QProgressBar(parent)),
+    m_cancelButton(new QToolButton(parent))
 {
+    m_progressBar->setRange(0, 100);
+    m_progressBar->setMaximumWidth(160);
+    m_progressBar->setFormat("Loading %p%");
+    m_progressBar->hide();
+    m_cancelButton->setText("Cancel");
+    m_cancelButton->setToolTip("Stop loading the rest of the file");
+    m_cancelButton->hide();
+
     m_statusLabel->setContentsMargins(0, 0, 8, 0);
+    m_qbar->addPermanentWidget(m_progressBar);
+    m_qbar->addPermanentWidget(m_cancelButton);
     m_qbar->addPermanentWidget(m_statusLabel);
 }
 
@@ -17,3 +29,21 @@ void StatusBar::SetRightLabelText(const QString& text)
 {
     m_statusLabel->setText(text);
 }
+
+void StatusBar::ShowProgress(int percent)
+{
+    m_progressBar->setValue(percent);
+    m_progressBar->show();
+    m_cancelButton->show();
+}
+
+void StatusBar::HideProgress()
+{
+    m_progressBar->hide();
+    m_cancelButton->hide();
+}
+
+QAbstractButton* StatusBar::GetCancelButton() const
+{
+    return m_cancelButton;
+}
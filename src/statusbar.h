@@ -9,10 +9,15 @@ public:
     StatusBar(QMainWindow* parent);
     void ShowMessage(const QString& message, int timeout);
     void SetRightLabelText(const QString& text);
+    void ShowProgress(int percent);
+    void HideProgress();
+    QAbstractButton* GetCancelButton() const;
 
 private:
     QStatusBar *m_qbar;
     QLabel *m_statusLabel;
+    QProgressBar *m_progressBar;
+    QToolButton *m_cancelButton;
 };
 
 #endif // STATUSBAR_H
@@ -0,0 +1,103 @@
+#include "stringpool.h"
+
+#include <atomic>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+
+namespace
+{
+    // Strings are spread over shards so parser threads rarely wait on each other
+    const int ShardCount = 16;
+    // Strings are stored in chunks that never move, so Get() doesn't need a lock
+    const int ChunkBits = 16;
+    const quint32 ChunkSize = 1u << ChunkBits;
+    const quint32 MaxChunks = 1u << 12;
+    // Recently used codes are cached per thread, which skips the shard lock for repeated values
+    const qsizetype MaxCachedCodes = 4096;
+
+    struct Shard
+    {
+        QMutex mutex;
+        QHash<QString, quint32> codes;
+    };
+
+    Shard shards[ShardCount];
+    std::atomic<QString*> chunks[MaxChunks];
+    std::atomic<quint32> nextCode { 1 };
+    const QString nullString;
+
+    QString* GetChunk(quint32 chunkIndex)
+    {
+        QString* chunk = chunks[chunkIndex].load(std::memory_order_acquire);
+        if (!chunk)
+        {
+            QString* newChunk = new QString[ChunkSize];
+            if (chunks[chunkIndex].compare_exchange_strong(chunk, newChunk, std::memory_order_acq_rel))
+            {
+                chunk = newChunk;
+            }
+            else
+            {
+                // Another thread allocated it first
+                delete[] newChunk;
+            }
+        }
+        return chunk;
+    }
+}
+
+namespace StringPool
+{
+    quint32 Intern(const QString& str)
+    {
+        thread_local QHash<QString, quint32> cache;
+        auto cached = cache.constFind(str);
+        if (cached != cache.constEnd())
+            return cached.value();
+
+        quint32 code;
+        {
+            Shard& shard = shards[qHash(str) % ShardCount];
+            QMutexLocker locker(&shard.mutex);
+            auto it = shard.codes.constFind(str);
+            if (it != shard.codes.constEnd())
+            {
+                code = it.value();
+            }
+            else
+            {
+                code = nextCode++;
+                if ((code >> ChunkBits) >= MaxChunks)
+                {
+                    // Keeps the counter from wrapping around onto codes in use
+                    nextCode = MaxChunks << ChunkBits;
+                    return Uninterned;
+                }
+                GetChunk(code >> ChunkBits)[code & (ChunkSize - 1)] = str;
+                shard.codes.insert(str, code);
+            }
+        }
+
+        if (cache.size() >= MaxCachedCodes)
+        {
+            cache.clear();
+        }
+        cache.insert(str, code);
+        return code;
+    }
+
+    quint32 Find(const QString& str)
+    {
+        Shard& shard = shards[qHash(str) % ShardCount];
+        QMutexLocker locker(&shard.mutex);
+        return shard.codes.value(str, Null);
+    }
+
+    const QString& Get(quint32 code)
+    {
+        if (code == Null || code == Uninterned)
+            return nullString;
+        return chunks[code >> ChunkBits].load(std::memory_order_acquire)[code & (ChunkSize - 1)];
+    }
+}
@@ -0,0 +1,28 @@
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+#include <QString>
+
+// Process-wide table of interned strings.
+// Header fields such as the file, key, severity or thread repeat across millions of events, so
+// events keep a 32-bit code per field instead of a string. Codes are stable for the lifetime of
+// the process and can be compared directly: equal codes mean equal strings.
+// Strings are never freed, so fields whose values rarely repeat, such as request ids, are kept
+// by the events instead.
+// Interning and lookups are safe from any thread.
+namespace StringPool
+{
+    // The code of a field that isn't set. Intern() never returns it.
+    const quint32 Null = 0;
+    // The code of a string that is kept by its owner rather than in the pool, see Intern()
+    const quint32 Uninterned = 0xFFFFFFFF;
+
+    // Returns Uninterned once the pool is full, the caller then has to keep the string itself
+    quint32 Intern(const QString& str);
+    // Returns the code of a string that has been interned, or Null. Never adds the string.
+    quint32 Find(const QString& str);
+    // Returns the string for a code returned by Intern(), or a null string for Null and Uninterned
+    const QString& Get(quint32 code);
+}
+
+#endif // STRINGPOOL_H
@@ -1,4 +1,5 @@
 QT       += core gui
+QT       += concurrent
 QT       += network
 QT       += webenginewidgets
 QT       += widgets
@@ -14,17 +15,30 @@ FORMS       = \
     mainwindow.ui \
     optionsdlg.ui \
     savefilterdialog.ui \
-    valuedlg.ui 
+    timerangedlg.ui \
+    valuedlg.ui \
+    zipmembersdlg.ui
 
 HEADERS     = \
     colorlibrary.h \
     column.h \
+    columnstore.h \
+    eventloader.h \
+    eventparser.h \
+    filesnapshot.h \
+    filewatcher.h \
     filtertab.h \
     finddlg.h \
+    gzipreader.h \
     highlightdlg.h \
     highlightoptions.h \
+    logevent.h \
+    logindex.h \
+    logloader.h \
+    logsource.h \
     logtab.h \
     mainwindow.h \
+    memorybudget.h \
     options.h \
     optionsdlg.h \
     pathhelper.h \
@@ -32,24 +46,40 @@ HEADERS     = \
     savefilterdialog.h \
     searchopt.h \
     statusbar.h \
+    stringpool.h \
+    timerangedlg.h \
     tokenizer.h \
     treeitem.h \
     treemodel.h \
     valuedlg.h \
+    ziparchive.h \
+    zipmembersdlg.h \
     zoomabletreeview.h \
     themeutils.h \
+    timeutils.h \
     theme.h \
     qjsonutils.h
 
 SOURCES     = \
     colorlibrary.cpp \
+    columnstore.cpp \
+    eventloader.cpp \
+    eventparser.cpp \
+    filesnapshot.cpp \
+    filewatcher.cpp \
     filtertab.cpp \
     finddlg.cpp \
+    gzipreader.cpp \
     highlightdlg.cpp \
     highlightoptions.cpp \
+    logevent.cpp \
+    logindex.cpp \
+    logloader.cpp \
+    logsource.cpp \
     logtab.cpp \
     main.cpp \
     mainwindow.cpp \
+    memorybudget.cpp \
     options.cpp \
     optionsdlg.cpp \
     pathhelper.cpp \
@@ -57,12 +87,17 @@ SOURCES     = \
     savefilterdialog.cpp \
     searchopt.cpp \
     statusbar.cpp \
+    stringpool.cpp \
+    timerangedlg.cpp \
     tokenizer.cpp \
     treeitem.cpp \
     treemodel.cpp \
     valuedlg.cpp \
+    ziparchive.cpp \
+    zipmembersdlg.cpp \
     zoomabletreeview.cpp \
     themeutils.cpp \
+    timeutils.cpp \
     theme.cpp \
     qjsonutils.cpp
 
@@ -72,6 +107,14 @@ win32:RC_ICONS += ../resources/images/tlv.ico
 
 ICON = ../resources/images/tlv.icns
 
+# zlib, for opening compressed logs. Use the copy bundled with Qt unless Qt itself links the system one.
+qtConfig(system-zlib) {
+    LIBS += -lz
+} else {
+    QT += zlib-private
+    DEFINES += USE_QT_ZLIB
+}
+
 CONFIG += c++17
 CONFIG += x86_64 
 
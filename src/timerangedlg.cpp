@@ -0,0 +1,47 @@
+#include "timerangedlg.h"
+#include "ui_timerangedlg.h"
+
+#include "timeutils.h"
+
+namespace
+{
+    const QString EditFormat = "yyyy-MM-dd HH:mm:ss.zzz";
+
+    qint64 ToTime(const QDateTime& dateTime)
+    {
+        return TimeUtils::ParseTimestamp(dateTime.toString("yyyy-MM-ddTHH:mm:ss.zzz"));
+    }
+}
+
+TimeRangeDlg::TimeRangeDlg(QWidget *parent, const QString& fileName, qint64 firstTime, qint64 lastTime) :
+    QDialog(parent),
+    ui(new Ui::TimeRangeDlg)
+{
+    setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
+    ui->setupUi(this);
+    setWindowTitle(QString("Open time range of %1").arg(fileName));
+
+    ui->label->setText(QString("The file covers %1 to %2.").arg(
+        TimeUtils::FormatTime(firstTime, true), TimeUtils::FormatTime(lastTime, true)));
+    ui->startEdit->setDisplayFormat(EditFormat);
+    ui->endEdit->setDisplayFormat(EditFormat);
+    ui->startEdit->setDateTime(TimeUtils::ToDateTime(firstTime));
+    // Round the end up so the last event isn't cut off by the edit dropping its microseconds
+    ui->endEdit->setDateTime(TimeUtils::ToDateTime(lastTime).addMSecs(1));
+    ui->startEdit->setFocus();
+}
+
+TimeRangeDlg::~TimeRangeDlg()
+{
+    delete ui;
+}
+
+qint64 TimeRangeDlg::GetStartTime() const
+{
+    return ToTime(ui->startEdit->dateTime());
+}
+
+qint64 TimeRangeDlg::GetEndTime() const
+{
+    return ToTime(ui->endEdit->dateTime());
+}
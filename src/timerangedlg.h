@@ -0,0 +1,28 @@
+#ifndef TIMERANGEDLG_H
+#define TIMERANGEDLG_H
+
+#include <QDialog>
+#include <QString>
+
+namespace Ui {
+class TimeRangeDlg;
+}
+
+// Asks for the range of times to load from a log file, starting out with all of the file
+class TimeRangeDlg : public QDialog
+{
+    Q_OBJECT
+
+public:
+    // Times are in microseconds, as TimeUtils holds them
+    explicit TimeRangeDlg(QWidget *parent, const QString& fileName, qint64 firstTime, qint64 lastTime);
+    ~TimeRangeDlg();
+
+    qint64 GetStartTime() const;
+    qint64 GetEndTime() const;
+
+private:
+    Ui::TimeRangeDlg *ui;
+};
+
+#endif // TIMERANGEDLG_H
@@ -0,0 +1,149 @@
+#include "timeutils.h"
+
+namespace
+{
+    const qint64 USecsPerSec = 1000000;
+    const qint64 USecsPerDay = 24 * 60 * 60 * USecsPerSec;
+    // Julian day of 1970-01-01
+    const qint64 EpochJulianDay = 2440588;
+
+    // Reads count digits at pos. Returns -1 if any of them isn't a digit.
+    int ReadDigits(QStringView str, int pos, int count)
+    {
+        int value = 0;
+        for (int i = pos; i < pos + count; i++)
+        {
+            const char16_t c = str[i].unicode();
+            if (c < u'0' || c > u'9')
+                return -1;
+            value = value * 10 + (c - u'0');
+        }
+        return value;
+    }
+
+    bool IsLeapYear(int year)
+    {
+        return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    }
+
+    int DaysInMonth(int year, int month)
+    {
+        static const int Days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+        return (month == 2 && IsLeapYear(year)) ? 29 : Days[month - 1];
+    }
+
+    // Days from 1970-01-01 to a date of the proleptic Gregorian calendar
+    qint64 DaysFromCivil(int year, int month, int day)
+    {
+        year -= month <= 2;
+        const qint64 era = (year >= 0 ? year : year - 399) / 400;
+        const qint64 yearOfEra = year - era * 400;
+        const qint64 dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+        const qint64 dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+        return era * 146097 + dayOfEra - 719468;
+    }
+
+    qint64 FloorDiv(qint64 a, qint64 b)
+    {
+        return (a >= 0) ? a / b : -((-a + b - 1) / b);
+    }
+
+    void AppendNumber(QString& str, qint64 value, int width)
+    {
+        str += QString::number(value).rightJustified(width, QLatin1Char('0'));
+    }
+
+    // Appends "hh:mm:ss.zzz[zzz]" for a time of day
+    void AppendTimeOfDay(QString& str, qint64 usecs, bool showUSecs)
+    {
+        const qint64 secs = usecs / USecsPerSec;
+        AppendNumber(str, secs / 3600, 2);
+        str += QLatin1Char(':');
+        AppendNumber(str, secs / 60 % 60, 2);
+        str += QLatin1Char(':');
+        AppendNumber(str, secs % 60, 2);
+        str += QLatin1Char('.');
+        const qint64 fraction = usecs % USecsPerSec;
+        if (showUSecs)
+            AppendNumber(str, fraction, 6);
+        else
+            AppendNumber(str, fraction / 1000, 3);
+    }
+}
+
+namespace TimeUtils {
+
+qint64 ParseTimestamp(QStringView ts)
+{
+    const int MillisecondSize = 23; // yyyy-MM-ddTHH:mm:ss.zzz
+    const int MicrosecondSize = 26; // yyyy-MM-ddTHH:mm:ss.zzzzzz
+    if (ts.size() != MillisecondSize && ts.size() != MicrosecondSize)
+        return InvalidTime;
+    if (ts[4] != u'-' || ts[7] != u'-' || ts[10] != u'T' || ts[13] != u':' || ts[16] != u':' || ts[19] != u'.')
+        return InvalidTime;
+
+    const int year = ReadDigits(ts, 0, 4);
+    const int month = ReadDigits(ts, 5, 2);
+    const int day = ReadDigits(ts, 8, 2);
+    const int hour = ReadDigits(ts, 11, 2);
+    const int minute = ReadDigits(ts, 14, 2);
+    const int second = ReadDigits(ts, 17, 2);
+    const int fraction = ReadDigits(ts, 20, ts.size() - 20);
+    if (year < 0 || month < 1 || month > 12 || day < 1 || day > DaysInMonth(year, month) ||
+        hour < 0 || hour > 23 || minute < 0 || minute > 59 || second < 0 || second > 59 || fraction < 0)
+        return InvalidTime;
+
+    const qint64 usecs = (ts.size() == MillisecondSize) ? fraction * 1000LL : fraction;
+    const qint64 secs = DaysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second;
+    return secs * USecsPerSec + usecs;
+}
+
+QDateTime ToDateTime(qint64 usecs)
+{
+    if (usecs == InvalidTime)
+        return QDateTime();
+
+    const qint64 days = FloorDiv(usecs, USecsPerDay);
+    const qint64 timeOfDay = usecs - days * USecsPerDay;
+    return QDateTime(QDate::fromJulianDay(days + EpochJulianDay),
+                     QTime::fromMSecsSinceStartOfDay(static_cast<int>(timeOfDay / 1000)));
+}
+
+QString FormatTime(qint64 usecs, bool withDate)
+{
+    if (usecs == InvalidTime)
+        return QString();
+
+    const qint64 days = FloorDiv(usecs, USecsPerDay);
+    const qint64 timeOfDay = usecs - days * USecsPerDay;
+    QString str;
+    str.reserve(32);
+    if (withDate)
+    {
+        int year, month, day;
+        QDate::fromJulianDay(days + EpochJulianDay).getDate(&year, &month, &day);
+        AppendNumber(str, month, 2);
+        str += QLatin1Char('/');
+        AppendNumber(str, day, 2);
+        str += QLatin1Char('/');
+        AppendNumber(str, year, 4);
+        str += QLatin1String(" - ");
+    }
+    AppendTimeOfDay(str, timeOfDay, usecs % 1000 != 0);
+    return str;
+}
+
+QString FormatDelta(qint64 usecs)
+{
+    QString str;
+    if (usecs < 0)
+    {
+        str += QLatin1Char('-');
+        usecs = -usecs;
+    }
+    // Hours are not wrapped to a day
+    AppendTimeOfDay(str, usecs, usecs % 1000 != 0);
+    return str;
+}
+
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include <limits>
+#include <QDateTime>
+#include <QString>
+#include <QStringView>
+
+// Event times are held as a count of microseconds since 1970-01-01T00:00:00 of the wall clock
+// time written in the log. Logs don't record a time zone, so no conversion is done: comparing
+// two times and taking deltas is plain integer arithmetic.
+namespace TimeUtils {
+    const qint64 InvalidTime = std::numeric_limits<qint64>::min();
+
+    // Parses "yyyy-MM-ddTHH:mm:ss.zzz" or "yyyy-MM-ddTHH:mm:ss.zzzzzz". Returns InvalidTime otherwise.
+    qint64 ParseTimestamp(QStringView ts);
+    // The local date time with the same wall clock time, truncated to milliseconds
+    QDateTime ToDateTime(qint64 usecs);
+    // "MM/dd/yyyy - hh:mm:ss.zzz", or "hh:mm:ss.zzz" without the date.
+    // Microseconds are shown when the time has any.
+    QString FormatTime(qint64 usecs, bool withDate);
+    // "hh:mm:ss.zzz" with a leading "-" for negative deltas
+    QString FormatDelta(qint64 usecs);
+}
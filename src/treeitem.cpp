@@ -56,9 +56,9 @@ bool TreeItem::InsertChildren(int position, int count, int columns)
     return true;
 }
 
-TreeItem * TreeItem::AddChild()
+TreeItem * TreeItem::AddChild(int columns)
 {
-    InsertChildren(ChildCount(), 1, ColumnCount());
+    InsertChildren(ChildCount(), 1, columns);
     return Child(ChildCount() - 1);
 }
 
@@ -86,8 +86,10 @@ bool TreeItem::RemoveChildren(int position, int count)
     if (position < 0 || position + count > m_childItems.size())
         return false;
 
-    for (int row = 0; row < count; ++row)
-        delete m_childItems.takeAt(position);
+    // One ranged erase. Erasing from the front only moves the start of the list, so dropping the
+    // oldest rows of a live tab costs the rows dropped, not the rows kept.
+    qDeleteAll(m_childItems.begin() + position, m_childItems.begin() + position + count);
+    m_childItems.remove(position, count);
 
     return true;
 }
@@ -114,3 +116,14 @@ bool TreeItem::SetData(int column, const QVariant &value)
     m_itemData[column] = value;
     return true;
 }
+
+// The children of an event are not created until they are first needed. See TreeModel::fetchMore.
+bool TreeItem::HasPendingChildren() const
+{
+    return m_pendingChildren;
+}
+
+void TreeItem::SetPendingChildren(bool pending)
+{
+    m_pendingChildren = pending;
+}
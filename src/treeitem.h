@@ -15,7 +15,7 @@ public:
     int ChildCount() const;
     int ColumnCount() const;
     QVariant Data(int column) const;
-    TreeItem * AddChild();
+    TreeItem * AddChild(int columns);
     bool InsertChildren(int position, int count, int columns);
     bool InsertColumns(int position, int columns);
     TreeItem *Parent();
@@ -23,11 +23,14 @@ public:
     bool RemoveColumns(int position, int columns);
     int ChildNumber() const;
     bool SetData(int column, const QVariant &value);
+    bool HasPendingChildren() const;
+    void SetPendingChildren(bool pending);
 
 private:
     QList<TreeItem*> m_childItems;
     QVector<QVariant> m_itemData;
     TreeItem * m_parentItem;
+    bool m_pendingChildren = false;
 };
 
 #endif // TREEITEM_H
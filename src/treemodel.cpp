@@ -1,13 +1,36 @@
 #include "treemodel.h"
 
+#include "eventloader.h"
+#include "eventparser.h"
+#include "memorybudget.h"
 #include "options.h"
 #include "qjsonutils.h"
+#include "stringpool.h"
 #include "themeutils.h"
+#include "timeutils.h"
 #include "treeitem.h"
 
+#include <QDir>
 #include <QJsonObject>
+#include <QTemporaryFile>
 #include <QtWidgets>
 
+// Limit string size in the tree view to prevent UI stutters.
+const int MaxDisplayStringSize = 300;
+// A new spill file is started past this, so the space of dropped rows is given back eventually
+const qint64 MaxSpillFileSize = 1024LL * 1024 * 1024;
+
+QString DisplayString(QString str)
+{
+    str.truncate(MaxDisplayStringSize);
+    str.replace("\n", " ");
+    return str;
+}
+
+void SetValueDisplayString(TreeItem* child, const QString& str)
+{
+    child->SetData(COL::Value, DisplayString(str));
+}
 
 TreeModel::TreeModel(const QStringList &headers, const EventListPtr events, QObject *parent)
     : QAbstractItemModel(parent)
@@ -18,7 +41,9 @@ TreeModel::TreeModel(const QStringList &headers, const EventListPtr events, QObj
 
     m_rootItem = new TreeItem(rootData);
     m_allEvents = events;
+    MemoryBudget::Register(this);
     SetupModelData(m_rootItem);
+    MemoryBudget::Check();
 
     HighlightOptions defaultHighlightOpts = Options::GetInstance().getDefaultHighlightOpts();
     if (!defaultHighlightOpts.isEmpty())
@@ -33,6 +58,7 @@ TreeModel::TreeModel(const QStringList &headers, const EventListPtr events, QObj
 
 TreeModel::~TreeModel()
 {
+    MemoryBudget::Unregister(this);
     delete m_rootItem;
 }
 
@@ -75,47 +101,66 @@ QVariant TreeModel::data(const QModelIndex &index, int role) const
         }
         case Qt::UserRole:
         {
-            TreeItem* item = GetItem(index);
-            return item->Data(col);
+            if (!IsTopLevel(index))
+                return GetItem(index)->Data(col);
+            if (col == COL::Value)
+                LoadValueString(index.row());
+            return RowData(index.row(), col);
         }
         case Qt::DisplayRole:
         {
-            TreeItem* item = GetItem(index);
-            if (col == COL::Time)
+            // Rows that are being shown are kept in memory, see SpillColdValues
+            if (IsTopLevel(index))
+                m_columns.Touch(index.row());
+
+            if (col == COL::ART)
+            {
+                // Display a black circle if ART data is present
+                // 0xE2978F = BLACK CIRCLE
+                QString blackCircle = QString::fromUtf8("\xE2\x97\x8F");
+                return (IsTopLevel(index) && m_columns.HasArt(index.row())) ? blackCircle : "";
+            }
+            else if (col == COL::ErrorCode)
+            {
+                // Display a black square if an error code is present
+                // 0xE296A0 = BLACK SQUARE
+                QString blackSquare = QString::fromUtf8("\xE2\x96\xA0");
+                return (IsTopLevel(index) && m_columns.HasErrorCode(index.row())) ? blackSquare : "";
+            }
+            else if (col == COL::Time)
             {
-                QDateTime dateTime = item->Data(col).toDateTime();
-                if (!dateTime.isValid())
+                qint64 usecs = IsTopLevel(index) ? TimeUSecs(index.row()) : TimeUtils::InvalidTime;
+                if (usecs == TimeUtils::InvalidTime)
                     return "";
 
                 switch (m_timeMode)
                 {
                    case TimeMode::GlobalDateTime:
-                      return dateTime.toString("MM/dd/yyyy - hh:mm:ss.zzz");
+                      return TimeUtils::FormatTime(usecs, true);
                    case TimeMode::GlobalTime:
-                      return dateTime.toString("hh:mm:ss.zzz");
+                      return TimeUtils::FormatTime(usecs, false);
                    case TimeMode::TimeDeltas:
-                      return GetDeltaMSecs(dateTime);
+                      return TimeUtils::FormatDelta(usecs - m_deltaBase);
                 }
             }
-            else if (col == COL::ART)
+
+            QVariant cell;
+            if (IsTopLevel(index))
             {
-                // Display a black circle if ART data is present
-                // 0xE2978F = BLACK CIRCLE
-                QString blackCircle = QString::fromUtf8("\xE2\x97\x8F");
-                return (item->Data(col).toString().isEmpty()) ? "" : blackCircle;
+                if (col == COL::Value)
+                    LoadValueString(index.row());
+                cell = RowData(index.row(), col);
             }
-            else if (col == COL::ErrorCode)
+            else
             {
-                // Display a black square if an error code is present
-                // 0xE296A0 = BLACK SQUARE
-                QString blackSquare = QString::fromUtf8("\xE2\x96\xA0");
-                return (item->Data(col).toString().isEmpty()) ? "" : blackSquare;
+                cell = GetItem(index)->Data(col);
             }
-            if (item->Data(col).typeId() == QMetaType::Double	)
+
+            if (cell.typeId() == QMetaType::Double)
             {
-                return QString::number(item->Data(col).toDouble(), 'f', 3);
+                return QString::number(cell.toDouble(), 'f', 3);
             }
-            return item->Data(col);
+            return cell;
         }
         case Qt::ToolTipRole:
         {
@@ -132,6 +177,10 @@ QVariant TreeModel::data(const QModelIndex &index, int role) const
                 }
                 return tip;
             }
+            else if (IsTopLevel(index))
+            {
+                return RowData(index.row(), col);
+            }
             else
             {
                 TreeItem* item = GetItem(index);
@@ -174,6 +223,27 @@ TreeItem *TreeModel::GetItem(const QModelIndex &index) const
     return m_rootItem;
 }
 
+bool TreeModel::IsTopLevel(const QModelIndex& index) const
+{
+    return index.isValid() && GetItem(index)->Parent() == m_rootItem;
+}
+
+// The fixed columns of an event. ART, Error Code and the strings that aren't interned are read
+// from the event when asked for.
+QVariant TreeModel::RowData(int row, int column) const
+{
+    if (row < 0 || row >= m_columns.Size())
+        return QVariant();
+
+    if (column == COL::ART)
+        return m_columns.HasArt(row) ? JsonToString(m_allEvents->at(row)["a"], false) : QVariant();
+    if (column == COL::ErrorCode)
+        return m_columns.HasErrorCode(row) ? JsonToString(m_allEvents->at(row)["e"], false) : QVariant();
+    if (ColumnStore::IsStringColumn(column) && m_columns.Code(row, column) == StringPool::Uninterned)
+        return m_allEvents->at(row).FieldString(ColumnStore::FieldOfColumn(column));
+    return m_columns.Data(row, column);
+}
+
 QString TreeModel::GetChildValueString(const QModelIndex &index, QString key) const
 {
     QJsonObject eventObj = GetEvent(index);
@@ -229,7 +299,20 @@ bool TreeModel::insertRows(int position, int rows, const QModelIndex &parent)
     bool success;
 
     beginInsertRows(parent, position, position + rows - 1);
-    success = parentItem->InsertChildren(position, rows, m_rootItem->ColumnCount());
+    if (!parent.isValid())
+    {
+        // Top-level rows keep their data in m_columns
+        success = parentItem->InsertChildren(position, rows, 0);
+        for (int i = 0; success && i < rows; i++)
+        {
+            m_allEvents->insert(position + i, LogEvent());
+            m_columns.Insert(position + i, LogEvent(), TimeUtils::InvalidTime);
+        }
+    }
+    else
+    {
+        success = parentItem->InsertChildren(position, rows, m_rootItem->ColumnCount());
+    }
     endInsertRows();
 
     return success;
@@ -277,22 +360,25 @@ bool TreeModel::removeRows(int position, int count, const QModelIndex &parent)
 
     beginRemoveRows(parent, position, endPosition);
     success = parentItem->RemoveChildren(position, count);
-    endRemoveRows();
-
-    if (success)
+    if (success && !parent.isValid())
     {
+        // The rows no longer match what was loaded from the files, a refresh reloads them all
+        m_fileSnapshots.clear();
         if (count == originalCount)
         {
             ClearAllEvents();
         }
         else
         {
-            for (int i = position; i <= endPosition; i++)
+            for (int row = position; row <= endPosition; row++)
             {
-                m_allEvents->removeAt(i);
+                m_heldValueBytes -= m_allEvents->at(row).HeldValueSize();
             }
+            m_allEvents->remove(position, count);
+            m_columns.Remove(position, count);
         }
     }
+    endRemoveRows();
 
     return success;
 }
@@ -304,9 +390,52 @@ int TreeModel::rowCount(const QModelIndex &parent) const
     return parentItem->ChildCount();
 }
 
+bool TreeModel::hasChildren(const QModelIndex &parent) const
+{
+    if (parent.column() <= 0 && GetItem(parent)->HasPendingChildren())
+        return true;
+
+    return QAbstractItemModel::hasChildren(parent);
+}
+
+bool TreeModel::canFetchMore(const QModelIndex &parent) const
+{
+    return parent.isValid() && parent.column() == 0 && GetItem(parent)->HasPendingChildren();
+}
+
+void TreeModel::fetchMore(const QModelIndex &parent)
+{
+    if (!canFetchMore(parent))
+        return;
+
+    TreeItem* item = GetItem(parent);
+    item->SetPendingChildren(false);
+
+    // Only top-level rows have pending children
+    int row = parent.row();
+    QJsonValue v = ConsolidateValueAndActivity(m_allEvents->at(row));
+    if (m_columns.ValueString(row).isNull())
+    {
+        m_columns.SetValueString(row, DisplayString(JsonToString(v, true, MaxDisplayStringSize)));
+    }
+
+    QJsonObject obj = v.toObject();
+    if (obj.isEmpty())
+    {
+        // Nothing to expand after all, let the view drop the expand indicator
+        emit dataChanged(parent, parent);
+        return;
+    }
+
+    beginInsertRows(parent, 0, obj.size() - 1);
+    AddChildren(obj, item);
+    endInsertRows();
+}
+
 bool TreeModel::setData(const QModelIndex &index, const QVariant &value, int role)
 {
-    if (role != Qt::EditRole)
+    // The fixed columns of the events are read only
+    if (role != Qt::EditRole || IsTopLevel(index))
         return false;
 
     TreeItem *item = GetItem(index);
@@ -332,29 +461,47 @@ bool TreeModel::setHeaderData(int section, Qt::Orientation orientation,
     return result;
 }
 
-QJsonObject TreeModel::GetEvent(QModelIndex idx) const
+int TreeModel::EventRow(QModelIndex idx) const
 {
     while (idx.parent().isValid())
     {
         idx = idx.parent();
     }
+    return idx.row();
+}
 
-    int row = idx.row();
+QJsonObject TreeModel::GetEvent(QModelIndex idx) const
+{
+    int row = EventRow(idx);
     if (row < 0)
     {
         return QJsonObject();
     }
     else
     {
-        return m_allEvents->at(idx.row());
+        return m_allEvents->at(row).ToObject();
+    }
+}
+
+LogEvent TreeModel::GetLogEvent(QModelIndex idx) const
+{
+    int row = EventRow(idx);
+    if (row < 0)
+    {
+        return LogEvent();
     }
+    return m_allEvents->at(row);
 }
 
 
 QJsonValue TreeModel::GetConsolidatedEventContent(QModelIndex idx) const
 {
-    QJsonObject eventObj = GetEvent(idx);
-    return ConsolidateValueAndActivity(eventObj);
+    int row = EventRow(idx);
+    if (row < 0)
+    {
+        return ConsolidateValueAndActivity(LogEvent());
+    }
+    return ConsolidateValueAndActivity(m_allEvents->at(row));
 }
 
 QString TreeModel::GetValueFullString(const QModelIndex& idx, bool singleLineFormat) const
@@ -372,14 +519,11 @@ void TreeModel::SetTabType(TABTYPE type)
     m_fileType = type;
 }
 
-static QDateTime parseTs(QString value) {
-    QString microsecondFormat = "yyyy-MM-ddTHH:mm:ss.zzzzzz";
-    QString millisecondFormat = "yyyy-MM-ddTHH:mm:ss.zzz";
-    if (value.size() == microsecondFormat.size()) {
-       // Hyper prints higher precision times that QT can't parse, so truncating here
-       value = value.left(millisecondFormat.size());
-    }
-    return QDateTime::fromString(value, millisecondFormat);
+qint64 TreeModel::TimeUSecs(int row) const
+{
+    if (row < 0 || row >= m_columns.Size())
+        return TimeUtils::InvalidTime;
+    return m_columns.Time(row);
 }
 
 /// <summary>
@@ -391,6 +535,9 @@ static QDateTime parseTs(QString value) {
 int TreeModel::MergeIntoModelData(const EventList& events)
 {
     int origIter = m_rootItem->ChildCount() - 1;
+    if (events.isEmpty())
+        return origIter;
+
     if (events[0]["ts"].toString().isEmpty())
     {
         AddToModelData(events);
@@ -399,11 +546,10 @@ int TreeModel::MergeIntoModelData(const EventList& events)
 
     for (int mergeIter = events.size() - 1; mergeIter >= 0; mergeIter--)
     {
-        QDateTime mergeTime = parseTs(events[mergeIter]["ts"].toString());
+        qint64 mergeTime = TimeUtils::ParseTimestamp(events[mergeIter].Timestamp());
         for (; origIter >= 0; origIter--)
         {
-            QDateTime origTime = m_rootItem->Child(origIter)->Data(COL::Time).toDateTime();
-            if (mergeTime >= origTime)
+            if (mergeTime >= m_columns.Time(origIter))
             {
                 InsertChild(origIter + 1, events[mergeIter]);
                 break;
@@ -421,112 +567,195 @@ int TreeModel::MergeIntoModelData(const EventList& events)
         }
     }
     layoutChanged();
+    MemoryBudget::Check();
 
     return origIter;
 }
 
-void TreeModel::AddToModelData(const EventList& events)
+// Merges several sorted lists of events into the model in one pass, then rebuilds the rows at once.
+// This is much cheaper than merging the lists one at a time when they interleave.
+void TreeModel::MergeIntoModelData(const QList<EventListPtr>& eventLists)
 {
-    for (const auto& event : events)
+    if (!m_allEvents->isEmpty() && m_allEvents->first().Timestamp().isEmpty())
     {
-        InsertChild(m_rootItem->ChildCount(), event);
+        // The rows have no times to merge on
+        for (const EventListPtr& events : eventLists)
+        {
+            AddToModelData(*events);
+        }
+        return;
     }
-    layoutChanged();
-}
 
-void TreeModel::InsertChild(int position, const QJsonObject & event)
-{
-    m_allEvents->insert(position, event);
-    m_rootItem->InsertChildren(position, 1, m_rootItem->ColumnCount());
-    auto child = m_rootItem->Child(position);
-    if (!child)
+    // When all the new events come after the last row, as when files grew, they are only appended
+    const qint64 lastTime = m_columns.Size() > 0 ? m_columns.Time(m_columns.Size() - 1) : TimeUtils::InvalidTime;
+    bool appendOnly = true;
+    for (const EventListPtr& events : eventLists)
+    {
+        if (!events->isEmpty() && TimeUtils::ParseTimestamp(events->first().Timestamp()) < lastTime)
+        {
+            appendOnly = false;
+            break;
+        }
+    }
+    if (appendOnly)
     {
-        qCritical() << "Cannot get item at" << position;
+        QList<const EventList*> lists;
+        for (const EventListPtr& events : eventLists)
+        {
+            lists.append(events.get());
+        }
+        AddToModelData(EventLoader::MergeSorted(lists));
         return;
     }
 
-    SetupChild(child, event);
+    QList<const EventList*> lists;
+    lists.append(m_allEvents.get());
+    for (const EventListPtr& events : eventLists)
+    {
+        lists.append(events.get());
+    }
+    EventList merged = EventLoader::MergeSorted(lists);
+
+    beginResetModel();
+    m_rootItem->RemoveChildren(0, m_rootItem->ChildCount());
+    m_columns.Clear();
+    m_heldValueBytes = 0;
+    m_highlightColorCache.clear();
+    *m_allEvents = std::move(merged);
+    SetupModelData(m_rootItem);
+    endResetModel();
+    MemoryBudget::Check();
 }
 
-void SetValueDisplayString(TreeItem* child, QString str)
+void TreeModel::AddToModelData(const EventList& events)
 {
-    // Limit string size in the tree view to prevent UI stutters.
-    const int MaxDisplayStringSize = 300;
+    if (events.isEmpty())
+        return;
 
-    str.truncate(MaxDisplayStringSize);
-    str.replace("\n", " ");
-    child->SetData(COL::Value, str);
-}
-
-void TreeModel::SetupChild(TreeItem *child, const QJsonObject & event)
-{
-    child->SetData(COL::ID, event["idx"].toInt());
-    child->SetData(COL::File, event["file"].toString());
-    child->SetData(COL::Time, parseTs(event["ts"].toString()));
-    child->SetData(COL::PID, event["pid"].toInt());
-    child->SetData(COL::TID, event["tid"].toString());
-    child->SetData(COL::Severity, event["sev"].toString());
-    child->SetData(COL::Request, event["req"].toString());
-    child->SetData(COL::Session, event["sess"].toString());
-    child->SetData(COL::Site, event["site"].toString());
-    child->SetData(COL::User, event["user"].toString());
-    child->SetData(COL::Key, event["k"].toString());
-    bool hasArtData = event.contains("a");
-    bool hasErrorCode = event.contains("e");
-    if (hasArtData)
+    int first = m_rootItem->ChildCount();
+    beginInsertRows(QModelIndex(), first, first + events.size() - 1);
+    m_allEvents->append(events);
+    for (int row = first; row < m_allEvents->size(); row++)
     {
-        child->SetData(COL::ART, JsonToString(event["a"], false));
+        m_rootItem->AddChild(0);
+        SetupChild(row, m_allEvents->at(row));
     }
-    if (hasErrorCode)
+    endInsertRows();
+    MemoryBudget::Check();
+}
+
+void TreeModel::InsertChild(int position, const LogEvent & event)
+{
+    if (!m_rootItem->InsertChildren(position, 1, 0))
     {
-        child->SetData(COL::ErrorCode, JsonToString(event["e"], false));
+        qCritical() << "Cannot insert item at" << position;
+        return;
     }
+    m_allEvents->insert(position, event);
 
-    QJsonValue v = ConsolidateValueAndActivity(event);
-    SetValueDisplayString(child, JsonToString(v));
-    if (v.isObject())
+    SetupChild(position, event);
+}
+
+// Keys of the value that fill the Elapsed column, in the order they are looked for.
+// Times in milliseconds are converted to seconds.
+static const char* const ElapsedKeys[] = {"created-elapsed", "elapsed", "elapsed-ms", "elapsedMs"};
+static const double ElapsedDivisors[] = {1, 1, 1000, 1000};
+static const int ElapsedKeyCount = 4;
+
+// Sets up the columns and the item of a new top-level row
+void TreeModel::SetupChild(int row, const LogEvent & event)
+{
+    TreeItem* child = m_rootItem->Child(row);
+    m_columns.Insert(row, event, TimeUtils::ParseTimestamp(event.Timestamp()));
+    m_heldValueBytes += event.HeldValueSize();
+    bool hasArtData = m_columns.HasArt(row);
+    bool hasErrorCode = m_columns.HasErrorCode(row);
+    QJsonObject valueObj;
+
+    if (event.HasPendingValue())
+    {
+        // "v" is parsed when the row is first painted or expanded
+        bool showART = hasArtData && Options::GetInstance().getShowArtDataInValue();
+        bool showErrorCode = hasErrorCode && Options::GetInstance().getShowErrorCodeInValue();
+        child->SetPendingChildren(showART || showErrorCode || event.RawValue().startsWith('{'));
+    }
+    else
     {
-        QJsonObject obj = v.toObject();
-        AddChildren(obj, child);
+        // The display string is formatted when the row is first painted (see LoadValueString),
+        // and the children are built when it is first expanded (see fetchMore)
+        valueObj = ConsolidateValueAndActivity(event).toObject();
+        child->SetPendingChildren(!valueObj.isEmpty());
     }
 
     // calculate "Elapsed"
-    if (child->Parent() == m_rootItem)
+    if (hasArtData)
     {
-        if (hasArtData)
+        QJsonObject artObject = event["a"].toObject();
+        if (artObject.contains("elapsed"))
         {
-            QJsonObject artObject = event["a"].toObject();
-            if (artObject.contains("elapsed"))
-            {
-                child->SetData(COL::Elapsed, artObject["elapsed"].toDouble());
-                return;
-            }
-        }
-        for (int i = 0; i < child->ChildCount(); i++)
-        {
-            auto c = child->Child(i);
-            if (c->Data(COL::Key) == "elapsed" || c->Data(COL::Key) == "created-elapsed")
-            {
-                auto val = c->Data(COL::Value);
-                child->SetData(COL::Elapsed, val.toDouble());
-                return;
-            }
-            else if (c->Data(COL::Key) == "elapsedMs" || c->Data(COL::Key) == "elapsed-ms")
-            {
-                auto val = c->Data(COL::Value);
-                child->SetData(COL::Elapsed, val.toDouble() / 1000);
-                return;
-            }
+            m_columns.SetElapsed(row, artObject["elapsed"].toDouble());
+            return;
         }
     }
+    if (event.HasPendingValue())
+    {
+        SetupPendingElapsed(row, event);
+        return;
+    }
+    for (int i = 0; i < ElapsedKeyCount; i++)
+    {
+        auto val = valueObj.constFind(QLatin1String(ElapsedKeys[i]));
+        if (val == valueObj.constEnd())
+            continue;
+
+        // Strings hold the number as text
+        double elapsed = val->isString() ? val->toString().toDouble() : val->toDouble();
+        m_columns.SetElapsed(row, elapsed / ElapsedDivisors[i]);
+        return;
+    }
+}
+
+void TreeModel::SetupPendingElapsed(int row, const LogEvent & event)
+{
+    // Same lookup as for a parsed value, reading the keys straight from the unparsed value
+    static const QList<QByteArrayView> ElapsedKeyViews(std::begin(ElapsedKeys), std::end(ElapsedKeys));
+
+    QList<QByteArrayView> values;
+    if (EventParser::FindMembers(event.RawValue(), ElapsedKeyViews, values) == 0)
+        return;
+
+    for (int i = 0; i < values.size(); i++)
+    {
+        QByteArrayView value = values[i];
+        if (value.isNull())
+            continue;
+
+        double elapsed = 0;
+        if (value.size() >= 2 && value.front() == '"')
+            elapsed = QByteArray::fromRawData(value.data() + 1, value.size() - 2).toDouble();
+        else
+            EventParser::ToDouble(value, elapsed);
+        m_columns.SetElapsed(row, elapsed / ElapsedDivisors[i]);
+        return;
+    }
+}
+
+void TreeModel::LoadValueString(int row) const
+{
+    if (row < 0 || row >= m_columns.Size() || !m_columns.ValueString(row).isNull())
+        return;
+
+    QJsonValue v = ConsolidateValueAndActivity(m_allEvents->at(row));
+    m_columns.SetValueString(row, DisplayString(JsonToString(v, true, MaxDisplayStringSize)));
 }
 
 void TreeModel::SetupModelData(TreeItem *parent)
 {
-    for (const auto& event : *m_allEvents)
+    m_columns.Reserve(m_allEvents->size());
+    for (int row = 0; row < m_allEvents->size(); row++)
     {
-        TreeItem* child = parent->AddChild();
-        SetupChild(child, event);
+        parent->AddChild(0);
+        SetupChild(row, m_allEvents->at(row));
     }
 }
 
@@ -540,7 +769,7 @@ void TreeModel::AddChildren(QJsonObject &obj, TreeItem *parent)
 
 void TreeModel::AddChild(const QString& key, const QJsonValue& value, TreeItem* parent)
 {
-    TreeItem* child = parent->AddChild();
+    TreeItem* child = parent->AddChild(m_rootItem->ColumnCount());
     child->SetData(COL::Key, key);
 
     if (value.isDouble())
@@ -559,7 +788,7 @@ void TreeModel::AddChild(const QString& key, const QJsonValue& value, TreeItem*
     else if (value.isObject())
     {
         QJsonObject childObj = value.toObject();
-        SetValueDisplayString(child, JsonToString(childObj));
+        SetValueDisplayString(child, JsonToString(childObj, true, MaxDisplayStringSize));
         AddChildren(childObj, child);
     }
     else if (value.isArray())
@@ -597,7 +826,7 @@ QColor TreeModel::ItemHighlightColor(const QModelIndex& idx) const
         auto highlightOpt = m_highlightOpts[revItr];
         for (auto key : highlightOpt.m_keys)
         {
-            QString columnStr;
+            bool match;
             if (key == COL::Value)
             {
                 if (valueStr.isNull())
@@ -605,14 +834,18 @@ QColor TreeModel::ItemHighlightColor(const QModelIndex& idx) const
                     // Cache value string so it's not calculated for all filters.
                     valueStr = GetValueFullString(idx, true);
                 }
-                columnStr = valueStr;
+                match = highlightOpt.HasMatch(valueStr);
+            }
+            else if (ColumnStore::IsStringColumn(key) && m_columns.Code(idx.row(), key) != StringPool::Uninterned)
+            {
+                match = HighlightMatchesCode(revItr, m_columns.Code(idx.row(), key));
             }
             else
             {
-                columnStr = item->Data(key).toString();
+                match = highlightOpt.HasMatch(RowData(idx.row(), key).toString());
             }
 
-            if (highlightOpt.HasMatch(columnStr))
+            if (match)
             {
                 m_highlightColorCache.insert(item, highlightOpt.m_backgroundColor);
                 return highlightOpt.m_backgroundColor;
@@ -624,7 +857,23 @@ QColor TreeModel::ItemHighlightColor(const QModelIndex& idx) const
     return Qt::transparent;
 }
 
-QString TreeModel::JsonToString(const QJsonValue& json, const bool isSingleLine) const
+bool TreeModel::HighlightMatchesCode(int filter, quint32 code) const
+{
+    if (m_highlightCodeMatches.size() != m_highlightOpts.count())
+        m_highlightCodeMatches.resize(m_highlightOpts.count());
+
+    QHash<quint32, bool>& matches = m_highlightCodeMatches[filter];
+    auto cached = matches.constFind(code);
+    if (cached != matches.constEnd())
+        return cached.value();
+
+    auto highlightOpt = m_highlightOpts[filter];
+    bool match = highlightOpt.HasMatch(StringPool::Get(code));
+    matches.insert(code, match);
+    return match;
+}
+
+QString TreeModel::JsonToString(const QJsonValue& json, const bool isSingleLine, int maxLength) const
 {
     using namespace QJsonUtils;
 
@@ -633,10 +882,10 @@ QString TreeModel::JsonToString(const QJsonValue& json, const bool isSingleLine)
         LineFormat::Free;
     QString notationName = Options::GetInstance().getNotation();
     Notation notation = QJsonUtils::GetNotationFromName(notationName);
-    return QJsonUtils::Format(json, notation, lineFormat);
+    return QJsonUtils::Format(json, notation, lineFormat, maxLength);
 }
 
-QJsonValue TreeModel::ConsolidateValueAndActivity(const QJsonObject& eventObject) const
+QJsonValue TreeModel::ConsolidateValueAndActivity(const LogEvent& eventObject) const
 {
     bool showART = eventObject.contains("a") && Options::GetInstance().getShowArtDataInValue();
     bool showErrorCode = eventObject.contains("e") && Options::GetInstance().getShowErrorCodeInValue();
@@ -644,10 +893,11 @@ QJsonValue TreeModel::ConsolidateValueAndActivity(const QJsonObject& eventObject
     if (showART || showErrorCode) {
         QJsonObject obj;
 
-        if (eventObject.contains("v") && eventObject["v"].type() == QJsonValue::Object)
-            obj = eventObject["v"].toObject();
+        QJsonValue value = eventObject["v"];
+        if (value.type() == QJsonValue::Object)
+            obj = value.toObject();
         else
-            obj["v"]=eventObject["v"]; // Create new object with "v"
+            obj["v"]=value; // Create new object with "v"
 
         if (showART) {
             // Using "~art" key so that it appears at the end, otherwise "a" is likely
@@ -674,12 +924,14 @@ void TreeModel::SetHighlightFilters(const HighlightOptions& highlightOpts)
 {
     m_highlightOpts = highlightOpts;
     m_highlightColorCache.clear();
+    m_highlightCodeMatches.clear();
 }
 
 void TreeModel::AddHighlightFilter(const SearchOpt& filter)
 {
     m_highlightOpts.append(filter);
     m_highlightColorCache.clear();
+    m_highlightCodeMatches.clear();
 }
 
 bool TreeModel::HasHighlightFilters() const
@@ -695,7 +947,11 @@ bool TreeModel::ValidFindOpts()
 void TreeModel::ClearAllEvents()
 {
     m_allEvents->clear();
+    m_columns.Clear();
+    m_heldValueBytes = 0;
     m_highlightColorCache.clear();
+    // Events exported to other tabs keep the file until they are gone
+    m_spillFile.reset();
 }
 
 void TreeModel::SetTimeMode(TimeMode mode)
@@ -714,27 +970,180 @@ void TreeModel::ShowDeltas(qint64 delta)
     m_deltaBase = delta;
 }
 
-QString TreeModel::GetDeltaMSecs(QDateTime dateTime) const
-{
-    auto msecs = dateTime.toMSecsSinceEpoch() - m_deltaBase;
-    bool isNegative = msecs < 0;
-    msecs = msecs < 0 ? -msecs : msecs;
-    int hours = msecs/(1000*60*60);
-    int minutes = (msecs-(hours*1000*60*60))/(1000*60);
-    int seconds = (msecs-(minutes*1000*60)-(hours*1000*60*60))/1000;
-    int milliseconds = msecs-(seconds*1000)-(minutes*1000*60)-(hours*1000*60*60);
-
-    return QString("%1%2:%3:%4.%5")
-        .arg(isNegative ? "-" : "")
-        .arg(hours, 2, 10, QLatin1Char('0'))
-        .arg(minutes, 2, 10, QLatin1Char('0'))
-        .arg(seconds, 2, 10, QLatin1Char('0'))
-        .arg(milliseconds, 3, 10, QLatin1Char('0'));
-}
-
 bool TreeModel::IsHighlightedRow(int row) const
 {
     QModelIndex idx = index(row, 0);
     bool highlighted = (ItemHighlightColor(idx) != Qt::transparent);
     return highlighted;
 }
+
+QList<int> TreeModel::FindRows(COL column, const QSet<QString>& values) const
+{
+    QList<int> rows;
+    if (!ColumnStore::IsStringColumn(column))
+    {
+        for (int row = 0; row < m_columns.Size(); row++)
+        {
+            if (values.contains(data(index(row, column), Qt::DisplayRole).toString()))
+                rows.append(row);
+        }
+        return rows;
+    }
+
+    // A string that was never interned can only be in the rows that keep their string.
+    // A missing field shows as empty.
+    QSet<quint32> codes;
+    for (const QString& value : values)
+    {
+        quint32 code = StringPool::Find(value);
+        if (code != StringPool::Null)
+            codes.insert(code);
+        if (value.isEmpty())
+            codes.insert(StringPool::Null);
+    }
+
+    for (int row = 0; row < m_columns.Size(); row++)
+    {
+        const quint32 code = m_columns.Code(row, column);
+        if (code == StringPool::Uninterned ? values.contains(RowData(row, column).toString()) : codes.contains(code))
+            rows.append(row);
+    }
+    return rows;
+}
+
+void TreeModel::RemoveTopLevelRows(const QList<int>& rows)
+{
+    // Remove from the end so the remaining rows stay valid
+    int end = rows.size();
+    while (end > 0)
+    {
+        int begin = end - 1;
+        while (begin > 0 && rows[begin - 1] == rows[begin] - 1)
+            --begin;
+        removeRows(rows[begin], end - begin);
+        end = begin;
+    }
+}
+
+qint64 TreeModel::HeldValueBytes() const
+{
+    return m_heldValueBytes;
+}
+
+// Writes the values held in memory of rows that weren't shown lately to a temporary file, and
+// reads them back through its mapping from then on. Rows are visited like a clock: a row that was
+// shown since the last visit only has its mark cleared, and is spilled on the next visit.
+qint64 TreeModel::SpillColdValues(qint64 bytes)
+{
+    const int count = m_allEvents->size();
+    if (m_spillHand >= count)
+        m_spillHand = 0;
+
+    QList<int> rows;
+    qint64 spilled = 0;
+    for (int i = 0; i < count && spilled < bytes; i++)
+    {
+        const int row = m_spillHand;
+        m_spillHand = (m_spillHand + 1) % count;
+        const qsizetype size = m_allEvents->at(row).HeldValueSize();
+        if (size == 0 || m_columns.TakeTouched(row))
+            continue;
+        rows.append(row);
+        spilled += size;
+    }
+    if (rows.isEmpty())
+        return 0;
+
+    // Every spill is appended to the same file. A full file is left to the events that still read
+    // from it, and removed once they are gone.
+    if (m_spillFile && m_spillFile->size() >= MaxSpillFileSize)
+        m_spillFile.reset();
+    if (!m_spillFile)
+    {
+        auto file = std::make_shared<QTemporaryFile>(QDir::temp().filePath("tlv-spill-XXXXXX"));
+        if (!file->open())
+            return 0;
+        m_spillFile = file;
+    }
+
+    const qint64 start = m_spillFile->size();
+    QList<qint64> offsets;
+    offsets.reserve(rows.size());
+    qint64 offset = 0;
+    bool written = m_spillFile->seek(start);
+    for (int i = 0; i < rows.size() && written; i++)
+    {
+        QByteArrayView value = m_allEvents->at(rows[i]).RawValue();
+        written = m_spillFile->write(value.data(), value.size()) == value.size();
+        offsets.append(offset);
+        offset += value.size();
+    }
+    std::shared_ptr<LogSource> source;
+    if (written && m_spillFile->flush())
+    {
+        source = LogSource::MapPart(m_spillFile, start, offset);
+    }
+    if (!source)
+    {
+        qWarning() << "Unable to write spill file" << m_spillFile->fileName();
+        // Nothing is left behind: a new file is removed, a used one is cut back
+        if (start == 0)
+            m_spillFile.reset();
+        else
+            m_spillFile->resize(start);
+        return 0;
+    }
+
+    for (int i = 0; i < rows.size(); i++)
+    {
+        (*m_allEvents)[rows[i]].SpillValue(source, offsets[i]);
+    }
+    // Only values held by the events themselves are spilled, so all of it is freed
+    m_heldValueBytes -= spilled;
+    return spilled;
+}
+
+void TreeModel::DetachFiles()
+{
+    // The events of a file are in runs, only a change of source needs a lookup
+    QSet<const LogSource*> detached;
+    const LogSource* last = nullptr;
+    for (const LogEvent& event : *m_allEvents)
+    {
+        LogSourcePtr source = event.FileSource();
+        if (!source || source.get() == last)
+            continue;
+        last = source.get();
+        if (!detached.contains(last))
+        {
+            source->Detach();
+            detached.insert(last);
+        }
+    }
+}
+
+void TreeModel::TrimOldestRows(int maxRows, qint64 maxBytes)
+{
+    // Estimated memory of a row besides its value: the event record, the tree item and the
+    // entries in the column arrays
+    const qint64 RowOverhead = sizeof(LogEvent) + sizeof(TreeItem) + 96;
+
+    const int rows = m_allEvents->size();
+    int count = (maxRows > 0 && rows > maxRows) ? rows - maxRows : 0;
+    if (maxBytes > 0)
+    {
+        qint64 excess = rows * RowOverhead + m_heldValueBytes - maxBytes;
+        int row = 0;
+        for (; row < rows && excess > 0; row++)
+        {
+            excess -= RowOverhead + m_allEvents->at(row).HeldValueSize();
+        }
+        count = qMax(count, row);
+    }
+    if (count > 0)
+    {
+        // The lists drop their front in place and reuse that space for the rows appended next,
+        // so a capped live tab works like a ring buffer
+        removeRows(0, count);
+    }
+}
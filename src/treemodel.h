@@ -2,7 +2,10 @@
 #define TREEMODEL_H
 
 #include "colorlibrary.h"
+#include "columnstore.h"
+#include "filesnapshot.h"
 #include "highlightoptions.h"
+#include "logevent.h"
 #include "searchopt.h"
 
 #include <memory>
@@ -11,6 +14,8 @@
 #include <QHash>
 #include <QJsonObject>
 #include <QModelIndex>
+#include <QSet>
+#include <QTemporaryFile>
 #include <QVariant>
 #include <queue>
 #include <utility>
@@ -18,7 +23,7 @@
 
 class TreeItem;
 typedef QHash<COL, QString> ColumnKeys;
-typedef QList<QJsonObject> EventList;
+typedef QList<LogEvent> EventList;
 typedef std::shared_ptr<EventList> EventListPtr;
 
 enum class TABTYPE {
@@ -48,6 +53,9 @@ public:
 
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
     int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
 
     Qt::ItemFlags flags(const QModelIndex &index) const override;
     bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
@@ -60,14 +68,33 @@ public:
 
     QString GetChildValueString(const QModelIndex &index, QString key) const;
     int MergeIntoModelData(const EventList& events);
+    void MergeIntoModelData(const QList<EventListPtr>& eventLists);
     void AddToModelData(const EventList& events);
     bool ValidFindOpts();
     void ClearAllEvents();
     void SetTimeMode(TimeMode mode);
     TimeMode GetTimeMode() const;
+    // delta is the time in microseconds that deltas are relative to
     void ShowDeltas(qint64 delta);
     bool IsHighlightedRow(int row) const;
+    // Time of a top-level row in microseconds, see TimeUtils
+    qint64 TimeUSecs(int row) const;
+    // Top-level rows whose column shows one of values. Dictionary encoded columns compare codes.
+    QList<int> FindRows(COL column, const QSet<QString>& values) const;
+    // Removes top-level rows, given in ascending order, a run of consecutive rows at a time
+    void RemoveTopLevelRows(const QList<int>& rows);
+    // Bytes of event values the model holds in memory, see MemoryBudget
+    qint64 HeldValueBytes() const;
+    // Spills about bytes of values of cold rows to disk. Returns how much was spilled.
+    qint64 SpillColdValues(qint64 bytes);
+    // Removes the oldest top-level rows until there are at most maxRows rows and they take up
+    // about maxBytes at most. 0 means no limit.
+    void TrimOldestRows(int maxRows, qint64 maxBytes);
+    // Copies the log files the values are read from into memory, for a live tab whose files
+    // may be truncated or replaced. See LogSource::Detach().
+    void DetachFiles();
     QJsonObject GetEvent(QModelIndex idx) const;
+    LogEvent GetLogEvent(QModelIndex idx) const;
     QJsonValue GetConsolidatedEventContent(QModelIndex idx) const;
     QString GetValueFullString(const QModelIndex& idx, bool singleLineFormat = false) const;
     TABTYPE TabType() const;
@@ -82,26 +109,43 @@ public:
     ColorLibrary m_colorLibrary;
     SearchOpt m_findOpts;
     QList<QString> m_paths;
+    // What was loaded from each of m_paths, for refreshing. Cleared when top-level rows are removed.
+    QHash<QString, FileSnapshot> m_fileSnapshots;
 
 private:
     void SetupModelData(TreeItem *parent);
-    void SetupChild(TreeItem *parent, const QJsonObject & event);
+    void SetupChild(int row, const LogEvent & event);
+    void SetupPendingElapsed(int row, const LogEvent & event);
+    void LoadValueString(int row) const;
+    QVariant RowData(int row, int column) const;
+    bool IsTopLevel(const QModelIndex& index) const;
     void AddChildren(QJsonObject &obj, TreeItem *parent);
     void AddChild(const QString& key, const QJsonValue& value, TreeItem* parent);
-    void InsertChild(int position, const QJsonObject & event);
-    QString JsonToString(const QJsonValue& json, const bool isSingleLine = true) const;
-    QJsonValue ConsolidateValueAndActivity(const QJsonObject& event) const;
+    void InsertChild(int position, const LogEvent & event);
+    int EventRow(QModelIndex idx) const;
+    QString JsonToString(const QJsonValue& json, const bool isSingleLine = true, int maxLength = -1) const;
+    QJsonValue ConsolidateValueAndActivity(const LogEvent& event) const;
     QColor ItemHighlightColor(const QModelIndex& idx) const;
-    QString GetDeltaMSecs(QDateTime dateTime) const;
+    bool HighlightMatchesCode(int filter, quint32 code) const;
     TreeItem *GetItem(const QModelIndex &index) const;
 
     TreeItem * m_rootItem;
     TimeMode m_timeMode = TimeMode::GlobalDateTime;
     qint64 m_deltaBase = 0;
     EventListPtr m_allEvents;
+    // Fixed columns of the top-level rows, one entry per event of m_allEvents
+    mutable ColumnStore m_columns;
+    qint64 m_heldValueBytes = 0;
+    // Where SpillColdValues continues looking for cold rows
+    int m_spillHand = 0;
+    // The file values are spilled to, shared with the sources of the spilled events
+    std::shared_ptr<QTemporaryFile> m_spillFile;
     TABTYPE m_fileType;
     HighlightOptions m_highlightOpts;
     mutable QHash<TreeItem*, QColor> m_highlightColorCache;
+    // Per highlight filter, whether the string of a code matches it.
+    // Dictionary encoded columns only have a few distinct values, so each is matched once.
+    mutable QList<QHash<quint32, bool>> m_highlightCodeMatches;
 };
 
 #endif // TREEMODEL_H
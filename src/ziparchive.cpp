@@ -0,0 +1,345 @@
+#include "ziparchive.h"
+
+#include <limits>
+#include <QDebug>
+#include <QFileInfo>
+#include <QtEndian>
+
+#ifdef USE_QT_ZLIB
+#include <QtZlib/zlib.h>
+#else
+#include <zlib.h>
+#endif
+
+namespace
+{
+    const quint32 LocalHeaderSignature = 0x04034b50;
+    const quint32 CentralHeaderSignature = 0x02014b50;
+    const quint32 EndOfCentralDirSignature = 0x06054b50;
+    const quint32 Zip64EndOfCentralDirSignature = 0x06064b50;
+    const quint32 Zip64LocatorSignature = 0x07064b50;
+
+    const qsizetype LocalHeaderSize = 30;
+    const qsizetype CentralHeaderSize = 46;
+    const qsizetype EndOfCentralDirSize = 22;
+    const qsizetype Zip64EndOfCentralDirSize = 56;
+    const qsizetype Zip64LocatorSize = 20;
+    const qsizetype MaxCommentSize = 0xFFFF;
+
+    const quint16 Zip64ExtraId = 0x0001;
+    const quint16 EncryptedFlag = 0x0001;
+    const quint16 Utf8NameFlag = 0x0800;
+    const quint16 MethodStored = 0;
+    const quint16 MethodDeflated = 8;
+
+    template <typename T>
+    T Read(const char* pos)
+    {
+        return qFromLittleEndian<T>(pos);
+    }
+}
+
+ZipArchive::ZipArchive(const QString& path)
+    : m_file(path)
+{
+}
+
+ZipArchive::~ZipArchive()
+{
+    if (m_mapped)
+    {
+        m_file.unmap(m_mapped);
+    }
+}
+
+bool ZipArchive::IsZipFile(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QByteArray magic = file.read(4);
+    return magic.size() == 4 && Read<quint32>(magic.constData()) == LocalHeaderSignature;
+}
+
+bool ZipArchive::SplitMemberPath(const QString& path, QString& archivePath, QString& memberName)
+{
+    // Walk up the path until it names an existing file
+    qsizetype separator = path.size();
+    while ((separator = path.lastIndexOf('/', separator - 1)) > 0)
+    {
+        QString candidate = path.left(separator);
+        QFileInfo fi(candidate);
+        if (fi.isFile())
+        {
+            if (!IsZipFile(candidate))
+                return false;
+            archivePath = candidate;
+            memberName = path.mid(separator + 1);
+            return true;
+        }
+        if (fi.exists())
+            return false;
+    }
+    return false;
+}
+
+bool ZipArchive::Open()
+{
+    if (!m_file.open(QIODevice::ReadOnly))
+        return false;
+
+    const qint64 size = m_file.size();
+    if (size > 0)
+    {
+        m_mapped = m_file.map(0, size);
+    }
+    if (m_mapped)
+    {
+        m_data = QByteArrayView(reinterpret_cast<const char*>(m_mapped), size);
+    }
+    else
+    {
+        m_buffer = m_file.readAll();
+        m_data = m_buffer;
+    }
+
+    if (!ReadCentralDirectory())
+    {
+        qWarning() << "Invalid or unsupported zip archive" << m_file.fileName();
+        m_entries.clear();
+        return false;
+    }
+    return true;
+}
+
+QString ZipArchive::GetPath() const
+{
+    return m_file.fileName();
+}
+
+const QList<ZipArchive::Entry>& ZipArchive::GetEntries() const
+{
+    return m_entries;
+}
+
+const ZipArchive::Entry* ZipArchive::FindEntry(const QString& name) const
+{
+    for (const Entry& entry : m_entries)
+    {
+        if (entry.name == name)
+            return &entry;
+    }
+    return nullptr;
+}
+
+// Returns a view of the archive, or a null view if the range is out of bounds
+QByteArrayView ZipArchive::Bytes(quint64 offset, quint64 size) const
+{
+    const quint64 total = static_cast<quint64>(m_data.size());
+    if (offset > total || size > total - offset)
+        return QByteArrayView();
+    return m_data.sliced(static_cast<qsizetype>(offset), static_cast<qsizetype>(size));
+}
+
+bool ZipArchive::ReadCentralDirectory()
+{
+    // The end of central directory record is at the end of the file, followed by a comment
+    // of up to 64 KB
+    if (m_data.size() < EndOfCentralDirSize)
+        return false;
+
+    qsizetype eocd = -1;
+    const qsizetype lowest = qMax<qsizetype>(0, m_data.size() - EndOfCentralDirSize - MaxCommentSize);
+    for (qsizetype pos = m_data.size() - EndOfCentralDirSize; pos >= lowest; pos--)
+    {
+        if (Read<quint32>(m_data.data() + pos) == EndOfCentralDirSignature)
+        {
+            eocd = pos;
+            break;
+        }
+    }
+    if (eocd < 0)
+        return false;
+
+    const char* record = m_data.data() + eocd;
+    quint64 entryCount = Read<quint16>(record + 10);
+    quint64 directorySize = Read<quint32>(record + 12);
+    quint64 directoryOffset = Read<quint32>(record + 16);
+
+    if (entryCount == 0xFFFF || directorySize == 0xFFFFFFFF || directoryOffset == 0xFFFFFFFF)
+    {
+        // ZIP64: the real values are in the ZIP64 end of central directory record
+        if (eocd < Zip64LocatorSize)
+            return false;
+        const char* locator = m_data.data() + eocd - Zip64LocatorSize;
+        if (Read<quint32>(locator) != Zip64LocatorSignature)
+            return false;
+        QByteArrayView zip64 = Bytes(Read<quint64>(locator + 8), Zip64EndOfCentralDirSize);
+        if (zip64.isNull() || Read<quint32>(zip64.data()) != Zip64EndOfCentralDirSignature)
+            return false;
+        entryCount = Read<quint64>(zip64.data() + 32);
+        directorySize = Read<quint64>(zip64.data() + 40);
+        directoryOffset = Read<quint64>(zip64.data() + 48);
+    }
+
+    QByteArrayView directory = Bytes(directoryOffset, directorySize);
+    if (directory.isNull())
+        return false;
+
+    m_entries.reserve(static_cast<qsizetype>(qMin<quint64>(entryCount, directorySize / CentralHeaderSize)));
+    qsizetype pos = 0;
+    for (quint64 i = 0; i < entryCount; i++)
+    {
+        if (directory.size() - pos < CentralHeaderSize)
+            return false;
+        const char* header = directory.data() + pos;
+        if (Read<quint32>(header) != CentralHeaderSignature)
+            return false;
+
+        Entry entry;
+        entry.flags = Read<quint16>(header + 8);
+        entry.method = Read<quint16>(header + 10);
+        entry.compressedSize = Read<quint32>(header + 20);
+        entry.uncompressedSize = Read<quint32>(header + 24);
+        const quint16 nameSize = Read<quint16>(header + 28);
+        const quint16 extraSize = Read<quint16>(header + 30);
+        const quint16 commentSize = Read<quint16>(header + 32);
+        entry.localHeaderOffset = Read<quint32>(header + 42);
+
+        const qsizetype entrySize = CentralHeaderSize + nameSize + extraSize + commentSize;
+        if (directory.size() - pos < entrySize)
+            return false;
+
+        const char* name = header + CentralHeaderSize;
+        // Archives made on Windows may not set the UTF-8 flag, but ziplogs member names are ASCII
+        entry.name = (entry.flags & Utf8NameFlag) ? QString::fromUtf8(name, nameSize) : QString::fromLatin1(name, nameSize);
+        entry.name.replace('\\', '/');
+
+        // Values that don't fit in 32 bits are moved to the ZIP64 extra field, in this order
+        const char* extra = name + nameSize;
+        const char* const extraEnd = extra + extraSize;
+        while (extraEnd - extra >= 4)
+        {
+            const quint16 id = Read<quint16>(extra);
+            const quint16 size = Read<quint16>(extra + 2);
+            const char* field = extra + 4;
+            const char* const fieldEnd = field + qMin<qsizetype>(size, extraEnd - field);
+            if (id == Zip64ExtraId)
+            {
+                if (entry.uncompressedSize == 0xFFFFFFFF && fieldEnd - field >= 8)
+                {
+                    entry.uncompressedSize = Read<quint64>(field);
+                    field += 8;
+                }
+                if (entry.compressedSize == 0xFFFFFFFF && fieldEnd - field >= 8)
+                {
+                    entry.compressedSize = Read<quint64>(field);
+                    field += 8;
+                }
+                if (entry.localHeaderOffset == 0xFFFFFFFF && fieldEnd - field >= 8)
+                {
+                    entry.localHeaderOffset = Read<quint64>(field);
+                }
+                break;
+            }
+            extra = fieldEnd;
+        }
+
+        if (!entry.name.endsWith('/'))
+        {
+            // Skip directories
+            m_entries.append(entry);
+        }
+        pos += entrySize;
+    }
+    return true;
+}
+
+bool ZipArchive::Extract(const Entry& entry, QByteArray& data) const
+{
+    if (entry.flags & EncryptedFlag)
+    {
+        qWarning() << "Encrypted zip members are not supported:" << entry.name;
+        return false;
+    }
+
+    // The data starts after the local header, whose name and extra field can differ in size
+    // from the ones in the central directory
+    QByteArrayView header = Bytes(entry.localHeaderOffset, LocalHeaderSize);
+    if (header.isNull() || Read<quint32>(header.data()) != LocalHeaderSignature)
+        return false;
+    const quint64 dataOffset = entry.localHeaderOffset + LocalHeaderSize +
+        Read<quint16>(header.data() + 26) + Read<quint16>(header.data() + 28);
+    QByteArrayView compressed = Bytes(dataOffset, entry.compressedSize);
+    if (compressed.isNull())
+        return false;
+
+    if (entry.method == MethodStored)
+    {
+        data = compressed.toByteArray();
+        return true;
+    }
+    if (entry.method != MethodDeflated)
+    {
+        qWarning() << "Unsupported compression method" << entry.method << "for" << entry.name;
+        return false;
+    }
+
+    // The size in the header is only used as a limit. Deflate doesn't compress better than about
+    // 1032:1, so a member claiming more is damaged. The buffer then grows with the data that is
+    // actually inflated, rather than being allocated up front from the header.
+    const quint64 maxRatio = 1032;
+    if (entry.uncompressedSize > static_cast<quint64>(compressed.size()) * maxRatio + 1024 ||
+        entry.uncompressedSize > static_cast<quint64>(std::numeric_limits<qsizetype>::max() / 2))
+    {
+        qWarning() << "Invalid uncompressed size for" << entry.name << "in" << m_file.fileName();
+        return false;
+    }
+
+    z_stream stream = {};
+    // Negative window bits: raw deflate data, without a zlib or gzip header
+    if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+        return false;
+
+    const quint64 initialSize = static_cast<quint64>(compressed.size()) * 4 + 0x10000;
+    data.resize(static_cast<qsizetype>(qMin(entry.uncompressedSize, initialSize)));
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressed.data()));
+
+    // avail_in and avail_out are 32 bits, feed members over 4 GB in slices
+    const quint64 maxSlice = 0x40000000;
+    quint64 inputLeft = compressed.size();
+    quint64 produced = 0;
+    int status = Z_OK;
+    while (status == Z_OK)
+    {
+        if (stream.avail_in == 0)
+        {
+            stream.avail_in = static_cast<uInt>(qMin(inputLeft, maxSlice));
+            inputLeft -= stream.avail_in;
+        }
+        if (produced == static_cast<quint64>(data.size()) && produced < entry.uncompressedSize)
+        {
+            data.resize(static_cast<qsizetype>(qMin(entry.uncompressedSize, produced * 2)));
+        }
+        // The buffer may have moved when it grew
+        stream.next_out = reinterpret_cast<Bytef*>(data.data() + produced);
+        stream.avail_out = static_cast<uInt>(qMin(static_cast<quint64>(data.size()) - produced, maxSlice));
+        const uInt room = stream.avail_out;
+        status = inflate(&stream, Z_NO_FLUSH);
+        produced += room - stream.avail_out;
+        if (status == Z_BUF_ERROR && (stream.avail_in != 0 || inputLeft != 0) && produced < entry.uncompressedSize)
+        {
+            status = Z_OK;
+        }
+    }
+    inflateEnd(&stream);
+
+    if (status != Z_STREAM_END || produced != entry.uncompressedSize)
+    {
+        qWarning() << "Failed to decompress" << entry.name << "from" << m_file.fileName();
+        data.clear();
+        return false;
+    }
+    return true;
+}
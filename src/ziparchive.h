@@ -0,0 +1,56 @@
+#ifndef ZIPARCHIVE_H
+#define ZIPARCHIVE_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QFile>
+#include <QList>
+#include <QString>
+
+// Read-only access to the members of a zip archive, such as the bundles made by
+// "tsm maintenance ziplogs".
+// The archive is memory-mapped and its central directory read once. Members are inflated
+// independently of each other, so Extract() can be called from several threads at a time.
+// Stored and deflated members are supported, including ZIP64 archives.
+class ZipArchive
+{
+public:
+    struct Entry
+    {
+        QString name;
+        quint64 compressedSize = 0;
+        quint64 uncompressedSize = 0;
+        quint64 localHeaderOffset = 0;
+        quint16 method = 0;
+        quint16 flags = 0;
+    };
+
+    explicit ZipArchive(const QString& path);
+    ~ZipArchive();
+
+    ZipArchive(const ZipArchive&) = delete;
+    ZipArchive& operator=(const ZipArchive&) = delete;
+
+    static bool IsZipFile(const QString& path);
+    // Splits a path to a member inside of an archive, like "logs.zip/node1/httpd.log", into
+    // the archive path and the member name. Returns false if no part of the path is a zip file.
+    static bool SplitMemberPath(const QString& path, QString& archivePath, QString& memberName);
+
+    bool Open();
+    QString GetPath() const;
+    const QList<Entry>& GetEntries() const;
+    const Entry* FindEntry(const QString& name) const;
+    bool Extract(const Entry& entry, QByteArray& data) const;
+
+private:
+    bool ReadCentralDirectory();
+    QByteArrayView Bytes(quint64 offset, quint64 size) const;
+
+    QFile m_file;
+    uchar* m_mapped = nullptr;
+    QByteArray m_buffer;
+    QByteArrayView m_data;
+    QList<Entry> m_entries;
+};
+
+#endif // ZIPARCHIVE_H
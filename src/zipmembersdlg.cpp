@@ -0,0 +1,77 @@
+#include "zipmembersdlg.h"
+#include "ui_zipmembersdlg.h"
+
+#include <QFileInfo>
+#include <QListWidgetItem>
+#include <QLocale>
+
+ZipMembersDlg::ZipMembersDlg(QWidget *parent, const ZipArchive& archive) :
+    QDialog(parent),
+    ui(new Ui::ZipMembersDlg)
+{
+    setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
+    ui->setupUi(this);
+    setWindowTitle(QString("Open %1").arg(QFileInfo(archive.GetPath()).fileName()));
+
+    // Log files are checked by default, configuration files and the like are not
+    const QStringList logSuffixes = {"log", "txt", "json"};
+    QLocale locale;
+    for (const ZipArchive::Entry& entry : archive.GetEntries())
+    {
+        QString text = QString("%1 (%2)").arg(entry.name, locale.formattedDataSize(static_cast<qint64>(entry.uncompressedSize)));
+        QListWidgetItem *item = new QListWidgetItem(text, ui->listWidget);
+        item->setData(Qt::UserRole, entry.name);
+        item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+        bool isLog = logSuffixes.contains(QFileInfo(entry.name).suffix(), Qt::CaseInsensitive);
+        item->setCheckState(isLog ? Qt::Checked : Qt::Unchecked);
+    }
+    ui->filterEdit->setFocus();
+}
+
+ZipMembersDlg::~ZipMembersDlg()
+{
+    delete ui;
+}
+
+QStringList ZipMembersDlg::GetCheckedMembers() const
+{
+    QStringList members;
+    for (int i = 0; i < ui->listWidget->count(); i++)
+    {
+        QListWidgetItem *item = ui->listWidget->item(i);
+        if (item->checkState() == Qt::Checked)
+        {
+            members.append(item->data(Qt::UserRole).toString());
+        }
+    }
+    return members;
+}
+
+void ZipMembersDlg::on_filterEdit_textChanged(const QString& text)
+{
+    for (int i = 0; i < ui->listWidget->count(); i++)
+    {
+        QListWidgetItem *item = ui->listWidget->item(i);
+        item->setHidden(!item->data(Qt::UserRole).toString().contains(text, Qt::CaseInsensitive));
+    }
+}
+
+void ZipMembersDlg::on_btnCheckVisible_clicked()
+{
+    for (int i = 0; i < ui->listWidget->count(); i++)
+    {
+        QListWidgetItem *item = ui->listWidget->item(i);
+        if (!item->isHidden())
+        {
+            item->setCheckState(Qt::Checked);
+        }
+    }
+}
+
+void ZipMembersDlg::on_btnUncheckAll_clicked()
+{
+    for (int i = 0; i < ui->listWidget->count(); i++)
+    {
+        ui->listWidget->item(i)->setCheckState(Qt::Unchecked);
+    }
+}
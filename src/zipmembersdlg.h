@@ -0,0 +1,33 @@
+#ifndef ZIPMEMBERSDLG_H
+#define ZIPMEMBERSDLG_H
+
+#include "ziparchive.h"
+
+#include <QDialog>
+#include <QStringList>
+
+namespace Ui {
+class ZipMembersDlg;
+}
+
+// Lists the members of an archive so the user can pick which ones to load
+class ZipMembersDlg : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit ZipMembersDlg(QWidget *parent, const ZipArchive& archive);
+    ~ZipMembersDlg();
+
+    QStringList GetCheckedMembers() const;
+
+private slots:
+    void on_filterEdit_textChanged(const QString& text);
+    void on_btnCheckVisible_clicked();
+    void on_btnUncheckAll_clicked();
+
+private:
+    Ui::ZipMembersDlg *ui;
+};
+
+#endif // ZIPMEMBERSDLG_H